@@ -0,0 +1,91 @@
+#include "api_fetch.h"
+
+/**
+ * Reads a response body a chunk at a time until it's complete or the attempt's deadline passes
+ * @param koTransport Connection to read from
+ * @param knDeadline  millis() the attempt must be over by
+ * @param sBody       Body read
+ * @return            HTTP_CODE_OK once complete, otherwise the transport's error or HTTPC_ERROR_READ_TIMEOUT
+ */
+static int readBody(const fetch_transport &koTransport, const uint32_t knDeadline, String &sBody)
+{
+    char acChunk[FETCH_READ_CHUNK + 1U];
+    sBody = "";
+    for (;;)
+    {
+        /* However small each wait, a trickling body can't outlast the deadline */
+        const int32_t knLeft = (int32_t)(knDeadline - millis());
+        if (knLeft <= 0) {
+            return HTTPC_ERROR_READ_TIMEOUT;
+        }
+        const int knRead = koTransport.pfRead((uint8_t *)acChunk, FETCH_READ_CHUNK, (uint32_t)knLeft, koTransport.pvContext);
+        if (knRead <= 0) {
+            return (knRead == 0) ? HTTP_CODE_OK : knRead;
+        }
+        acChunk[knRead] = '\0';
+        sBody.concat(acChunk);
+    }
+}
+
+fetch_result fetchJSON(api_endpoint &oEndpoint, JsonDocument &oDoc, const fetch_transport &koTransport)
+{
+    const bool kbCircuitOpen = (oEndpoint.nFailures >= FETCH_BREAKER_TRIPS);
+    if (kbCircuitOpen && ((int32_t)(millis() - oEndpoint.nRetryAt) < 0)) {
+        /* Circuit open, don't touch the network */
+        return useCachedResponse(oEndpoint, oDoc);
+    }
+
+    /* A half-open circuit only gets a single trial attempt */
+    const uint8_t knAttempts = kbCircuitOpen ? 1U : FETCH_ATTEMPTS;
+    String sBody;
+    for (uint8_t nAttempt = 0U; nAttempt < knAttempts; nAttempt++)
+    {
+        if (nAttempt > 0U) {
+            /* Back off exponentially, with the upper half jittered so both cores don't retry in lockstep */
+            const uint32_t knBackoff = FETCH_BACKOFF_BASE << (nAttempt - 1U);
+            delay((knBackoff / 2U) + (esp_random() % (knBackoff / 2U + 1U)));
+        }
+
+        /* The whole attempt, body included, has one deadline */
+        const uint32_t knDeadline = millis() + FETCH_ATTEMPT_TIMEOUT;
+        int nStatus = koTransport.pfRequest(oEndpoint.kpcURL, FETCH_ATTEMPT_TIMEOUT, koTransport.pvContext);
+        if (nStatus == HTTP_CODE_OK) {
+            nStatus = readBody(koTransport, knDeadline, sBody);
+        }
+        koTransport.pfEnd(koTransport.pvContext);
+        if (nStatus != HTTP_CODE_OK) {
+            Serial.printf("GET %s failed: %d\n", oEndpoint.kpcURL, nStatus);
+            continue;
+        }
+        /* Parse JSON, read error if any */
+        const DeserializationError koError = deserializeJson(oDoc, sBody.c_str());
+        if (koError) {
+            Serial.print(F("deserializeJson() failed: "));
+            Serial.println(koError.c_str());
+            continue;
+        }
+        /* Good response, close the circuit & keep it as the fallback */
+        oEndpoint.sCachedResponse = sBody;
+        oEndpoint.nFailures = 0U;
+        return FETCH_FRESH;
+    }
+
+    /* Every attempt failed, open (or re-open) the circuit once enough fetches have failed in a row */
+    if (oEndpoint.nFailures < FETCH_BREAKER_TRIPS) {
+        oEndpoint.nFailures++;
+    }
+    if (oEndpoint.nFailures >= FETCH_BREAKER_TRIPS) {
+        oEndpoint.nRetryAt = millis() + FETCH_BREAKER_COOLDOWN;
+    }
+    return useCachedResponse(oEndpoint, oDoc);
+}
+
+fetch_result useCachedResponse(api_endpoint &oEndpoint, JsonDocument &oDoc)
+{
+    if (oEndpoint.sCachedResponse.length() == 0U) {
+        oDoc.clear();
+        return FETCH_NONE;
+    }
+    deserializeJson(oDoc, oEndpoint.sCachedResponse.c_str());
+    return FETCH_CACHED;
+}
@@ -0,0 +1,88 @@
+//
+// Bounded, retried & circuit-broken JSON fetches, independent of the HTTP transport underneath.
+//
+
+#ifndef LED_BULLETIN_BOARD_API_FETCH_H
+#define LED_BULLETIN_BOARD_API_FETCH_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <HTTPClient.h>
+
+/* Bound on establishing a connection to an API */
+#define FETCH_CONNECT_TIMEOUT   2000U
+/* Bound on a whole attempt: connecting, waiting for the status & reading the body */
+#define FETCH_ATTEMPT_TIMEOUT   3000U
+/* Body bytes read at a time */
+#define FETCH_READ_CHUNK        64U
+/* Attempts per fetch before falling back to cached data */
+#define FETCH_ATTEMPTS          3U
+/* Backoff before the first retry, doubled every attempt after */
+#define FETCH_BACKOFF_BASE      250U
+/* Consecutive failed fetches before an endpoint's circuit opens */
+#define FETCH_BREAKER_TRIPS     3U
+/* How long an open circuit keeps an endpoint off the network (5 minutes) */
+#define FETCH_BREAKER_COOLDOWN  (5U*60000U)
+
+/* Where the data in the document came from after a fetch */
+enum FetchResult {
+    FETCH_FRESH,    /* Fetched from the endpoint just now */
+    FETCH_CACHED,   /* Endpoint unavailable, last good response restored */
+    FETCH_NONE      /* Endpoint unavailable and nothing cached, document is empty */
+};
+typedef enum FetchResult fetch_result;
+
+typedef struct API_ENDPOINT {
+    const char *kpcURL;             /* Request URL */
+    String      sCachedResponse;    /* Last response that parsed successfully */
+    uint8_t     nFailures;          /* Consecutive failed fetches (capped at FETCH_BREAKER_TRIPS) */
+    uint32_t    nRetryAt;           /* millis() after which an open circuit lets one attempt through */
+} api_endpoint;
+
+/* How a fetch reaches the network. fetchJSON() hands every call the time left before the attempt's deadline. */
+typedef struct FETCH_TRANSPORT {
+    /**
+     * Sends a GET request & waits for the status
+     * @param kpcURL    Request URL
+     * @param knTimeout Most milliseconds to take
+     * @param pvContext Transport's own data
+     * @return          HTTP status, or a negative HTTPClient error (e.g. HTTPC_ERROR_READ_TIMEOUT)
+     */
+    int (*pfRequest)(const char *kpcURL, const uint32_t knTimeout, void *pvContext);
+    /**
+     * Reads what has arrived of the body, waiting for some if nothing has
+     * @param pnBuffer  Output
+     * @param knSize    Most bytes to read
+     * @param knTimeout Most milliseconds to wait
+     * @param pvContext Transport's own data
+     * @return          Bytes read, 0 once the body is complete, or a negative HTTPClient error
+     */
+    int (*pfRead)(uint8_t *pnBuffer, const size_t knSize, const uint32_t knTimeout, void *pvContext);
+    /**
+     * Closes the connection, after every request whatever its outcome
+     */
+    void (*pfEnd)(void *pvContext);
+    void *pvContext;    /* Transport's own data */
+} fetch_transport;
+
+/**
+ * Fetches an endpoint into a JSON document.
+ * Each attempt must return HTTP_CODE_OK with valid JSON within FETCH_ATTEMPT_TIMEOUT, however slowly the body arrives.
+ * Failed attempts are retried with jittered exponential backoff, and after FETCH_BREAKER_TRIPS failed fetches in a row
+ * the endpoint's circuit opens for FETCH_BREAKER_COOLDOWN, during which the last good response is served without a request.
+ * @param oEndpoint   Target endpoint
+ * @param oDoc        Document to fill
+ * @param koTransport Makes the requests
+ * @return            Where the data now in oDoc came from
+ */
+fetch_result fetchJSON(api_endpoint &oEndpoint, JsonDocument &oDoc, const fetch_transport &koTransport);
+
+/**
+ * Restores the endpoint's last good response into a document, so callers never read a failed response
+ * @param oEndpoint Endpoint to fall back on
+ * @param oDoc      Document to fill
+ * @return          FETCH_CACHED, or FETCH_NONE if nothing has been cached yet
+ */
+fetch_result useCachedResponse(api_endpoint &oEndpoint, JsonDocument &oDoc);
+
+#endif //LED_BULLETIN_BOARD_API_FETCH_H
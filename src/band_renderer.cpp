@@ -0,0 +1,58 @@
+#include "band_renderer.h"
+
+bool BandRenderer::begin(ShadowMatrixPanel *poTarget, const BaseType_t knHelperCore)
+{
+    poPanel = poTarget;
+    oHelperTask = NULL;
+    memset(&oStats, 0, sizeof(oStats));
+    memset(anFrame, 0, sizeof(anFrame));
+    return (xTaskCreatePinnedToCore(helperLoop, "BandTask", 2000, this, 2, &oHelperTask, knHelperCore) == pdPASS);
+}
+
+void BandRenderer::renderFrame(band_fill_fn pfFill, void *pvContext, const panel_rect &koWindow)
+{
+    panel_rect oCallerBand = koWindow;
+
+    if (oHelperTask != NULL) {
+        /* Hand the top band to the other core */
+        const uint8_t knHelperRows = koWindow.nHeight / 2U;
+        pfPendingFill    = pfFill;
+        pvPendingContext = pvContext;
+        oPendingBand     = {koWindow.nLeft, koWindow.nTop, koWindow.nWidth, knHelperRows};
+        oCallerTask      = xTaskGetCurrentTaskHandle();
+        xTaskNotifyGive(oHelperTask);
+        oCallerBand.nTop    += knHelperRows;
+        oCallerBand.nHeight -= knHelperRows;
+    }
+
+    /* Fill our own band meanwhile */
+    const uint32_t knFillStart = micros();
+    pfFill(anFrame, oCallerBand, pvContext);
+    const uint32_t knWaitStart = micros();
+    if (oHelperTask != NULL) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+
+    /* One flush, only for the pixels that changed */
+    const uint32_t knFlushStart = micros();
+    oStats.nLastFlushPixels = poPanel->drawFrame444(anFrame, koWindow);
+    oStats.nLastWindowPixels = (uint32_t)koWindow.nWidth * koWindow.nHeight;
+    oStats.nLastFlushUs = micros() - knFlushStart;
+    oStats.nLastWaitUs  = knFlushStart - knWaitStart;
+    oStats.nLastFillUs  = knWaitStart - knFillStart;
+    oStats.nFrames++;
+}
+
+/**
+ * Helper task - fills the top band whenever a frame is started
+ * @param pvSelf The renderer
+ */
+void BandRenderer::helperLoop(void *pvSelf)
+{
+    BandRenderer *poSelf = (BandRenderer *)pvSelf;
+    for(;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        poSelf->pfPendingFill(poSelf->anFrame, poSelf->oPendingBand, poSelf->pvPendingContext);
+        xTaskNotifyGive(poSelf->oCallerTask);
+    }
+}
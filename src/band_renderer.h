@@ -0,0 +1,62 @@
+//
+// Renders frames in row bands split across both ESP32 cores, then flushes them to the panel once. A frame can be
+// limited to a window, so drawing a fixed-size graphic costs the same however large the board is.
+//
+
+#ifndef LED_BULLETIN_BOARD_BAND_RENDERER_H
+#define LED_BULLETIN_BOARD_BAND_RENDERER_H
+
+#include <Arduino.h>
+#include "shadow_panel.h"
+
+/**
+ * Fills one band of a frame, touching nothing outside it
+ * @param panFrame  Whole frame, 0x0RGB
+ * @param koBand    Part of the frame to fill: the top or bottom rows of the window
+ * @param pvContext Caller's data, shared read-only by both cores
+ */
+typedef void (*band_fill_fn)(uint16_t (*panFrame)[PANEL_WIDTH], const panel_rect &koBand, void *pvContext);
+
+typedef struct RENDER_STATS {
+    uint32_t    nFrames;            /* Frames rendered */
+    uint32_t    nLastFillUs;        /* Time the caller spent filling its band (microseconds) */
+    uint32_t    nLastWaitUs;        /* Time the caller then waited for the helper's band (microseconds) */
+    uint32_t    nLastFlushUs;       /* Time spent pushing changed pixels to the panel (microseconds) */
+    uint32_t    nLastFlushPixels;   /* Pixels that changed */
+    uint32_t    nLastWindowPixels;  /* Pixels filled & compared against the panel */
+} render_stats;
+
+class BandRenderer {
+public:
+    /**
+     * Starts the helper task
+     * @param poTarget     Panel to flush to
+     * @param knHelperCore Core for the helper band, the other one from the caller's
+     * @return             Whether the helper started (otherwise the caller fills every band)
+     */
+    bool begin(ShadowMatrixPanel *poTarget, const BaseType_t knHelperCore);
+
+    /**
+     * Fills a window of the frame on both cores in parallel, the helper taking the top half of its rows, then draws
+     * what changed in it (call with exclusive matrix access). The panel outside the window is left as it is.
+     * @param pfFill    Fills each band
+     * @param pvContext Passed to pfFill
+     * @param koWindow  Part of the frame to render
+     */
+    void renderFrame(band_fill_fn pfFill, void *pvContext, const panel_rect &koWindow = koPanelRect);
+
+    render_stats oStats;
+
+private:
+    static void helperLoop(void *pvSelf);
+
+    ShadowMatrixPanel  *poPanel;
+    TaskHandle_t        oHelperTask;
+    TaskHandle_t        oCallerTask;
+    band_fill_fn        pfPendingFill;
+    void               *pvPendingContext;
+    panel_rect          oPendingBand;
+    uint16_t            anFrame[PANEL_HEIGHT][PANEL_WIDTH];
+};
+
+#endif //LED_BULLETIN_BOARD_BAND_RENDERER_H
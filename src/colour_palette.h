@@ -0,0 +1,117 @@
+//
+// Gamma-corrected brightness tables: what each 4-bit colour channel becomes on the driver's 5-bit scale at each panel
+// brightness level.
+//
+
+#ifndef LED_BULLETIN_BOARD_COLOUR_PALETTE_H
+#define LED_BULLETIN_BOARD_COLOUR_PALETTE_H
+
+#include <stdint.h>
+
+/* Levels of 4 bits per channel */
+#define PALETTE_CHANNEL_STEPS   16U
+/* Brightest driver level of a channel (color555(), the driver holds 5 bits a channel) */
+#define PALETTE_DRIVER_MAX      31U
+
+/* Panel brightness, as perceived (percent of full) */
+enum BrightnessLevels {
+    BRIGHTNESS_30,
+    BRIGHTNESS_40,
+    BRIGHTNESS_55,
+    BRIGHTNESS_70,
+    BRIGHTNESS_85,
+    BRIGHTNESS_100,
+    BRIGHTNESS_LEVELS
+};
+
+/*
+ * LED duty is linear but the eye isn't, so each level scales a channel's full driver level (value * 31 / 15) by
+ * (percent / 100) ^ 2.2, rounded, with lit channels kept at 1 or above so dim colours keep their hue rather than
+ * going out. 30% is as low as it goes: at 25% every lit channel rounds to 1 & grey blurs into white.
+ */
+constexpr uint8_t kanBrightnessTable[BRIGHTNESS_LEVELS][PALETTE_CHANNEL_STEPS] = {
+    /* BRIGHTNESS_30  */ {0U, 1U, 1U, 1U, 1U,  1U,  1U,  1U,  1U,  1U,  1U,  2U,  2U,  2U,  2U,  2U},
+    /* BRIGHTNESS_40  */ {0U, 1U, 1U, 1U, 1U,  1U,  2U,  2U,  2U,  2U,  3U,  3U,  3U,  4U,  4U,  4U},
+    /* BRIGHTNESS_55  */ {0U, 1U, 1U, 2U, 2U,  3U,  3U,  4U,  4U,  5U,  6U,  6U,  7U,  7U,  8U,  8U},
+    /* BRIGHTNESS_70  */ {0U, 1U, 2U, 3U, 4U,  5U,  6U,  7U,  8U,  8U,  9U, 10U, 11U, 12U, 13U, 14U},
+    /* BRIGHTNESS_85  */ {0U, 1U, 3U, 4U, 6U,  7U,  9U, 10U, 12U, 13U, 14U, 16U, 17U, 19U, 20U, 22U},
+    /* BRIGHTNESS_100 */ {0U, 2U, 4U, 6U, 8U, 10U, 12U, 14U, 17U, 19U, 21U, 23U, 25U, 27U, 29U, 31U},
+};
+
+/*=== N A M E D   C O L O U R S ===*/
+
+/* Colours the sketch draws with, as 0x0RGB */
+#define COLOUR_BLACK    0x000U
+#define COLOUR_BLUE     0x00FU
+#define COLOUR_GREEN    0x0F0U
+#define COLOUR_RED      0xF00U
+#define COLOUR_YELLOW   0xFF0U
+#define COLOUR_CYAN     0x0FFU
+#define COLOUR_PURPLE   0xF0FU
+#define COLOUR_WHITE    0xFFFU
+#define COLOUR_GREY     0x444U
+#define COLOUR_BROWN    0x220U
+#define COLOUR_TODO     0x05FU
+/* Hourglass sand & its darker grains */
+#define COLOUR_SAND_1   0xF80U
+#define COLOUR_SAND_2   0x500U
+
+/* Every named colour, which must still be told apart at every brightness level */
+constexpr uint16_t kanNamedColours[] = {
+    COLOUR_BLACK, COLOUR_BLUE, COLOUR_GREEN, COLOUR_RED, COLOUR_YELLOW, COLOUR_CYAN, COLOUR_PURPLE,
+    COLOUR_WHITE, COLOUR_GREY, COLOUR_BROWN, COLOUR_TODO, COLOUR_SAND_1, COLOUR_SAND_2
+};
+#define NAMED_COLOUR_COUNT  (sizeof(kanNamedColours) / sizeof(kanNamedColours[0]))
+
+/*=== C H E C K S ===*/
+
+constexpr bool brightnessRowValid(uint8_t nLevel, uint8_t nStep)
+{
+    return (nStep >= PALETTE_CHANNEL_STEPS) ? true
+        : ((kanBrightnessTable[nLevel][nStep] <= PALETTE_DRIVER_MAX)
+           && ((nStep == 0U) ? (kanBrightnessTable[nLevel][0] == 0U) : (kanBrightnessTable[nLevel][nStep] >= kanBrightnessTable[nLevel][nStep - 1U]))
+           && ((nLevel == 0U) || (kanBrightnessTable[nLevel][nStep] >= kanBrightnessTable[nLevel - 1U][nStep]))
+           && brightnessRowValid(nLevel, nStep + 1U));
+}
+
+constexpr bool brightnessTableValid(uint8_t nLevel)
+{
+    return (nLevel >= BRIGHTNESS_LEVELS) ? true
+        : (brightnessRowValid(nLevel, 0U) && brightnessTableValid(nLevel + 1U));
+}
+
+constexpr bool brightnessFullScale(uint8_t nStep)
+{
+    return (nStep >= PALETTE_CHANNEL_STEPS) ? true
+        : ((kanBrightnessTable[BRIGHTNESS_100][nStep] == ((nStep * PALETTE_DRIVER_MAX + 7U) / 15U)) && brightnessFullScale(nStep + 1U));
+}
+
+/**
+ * @return 0x0RGB colour as a brightness level shows it, as 5-bit channels 0bRRRRRGGGGGBBBBB
+ */
+constexpr uint16_t brightnessDimmed(uint8_t nLevel, uint16_t n444)
+{
+    return (uint16_t)((kanBrightnessTable[nLevel][(n444 >> 8U) & 0xFU] << 10U)
+                      | (kanBrightnessTable[nLevel][(n444 >> 4U) & 0xFU] << 5U)
+                      | kanBrightnessTable[nLevel][n444 & 0xFU]);
+}
+
+constexpr bool namedColourUnique(uint8_t nLevel, uint8_t nColour, uint8_t nOther)
+{
+    return (nOther >= NAMED_COLOUR_COUNT) ? true
+        : ((brightnessDimmed(nLevel, kanNamedColours[nColour]) != brightnessDimmed(nLevel, kanNamedColours[nOther]))
+           && namedColourUnique(nLevel, nColour, nOther + 1U));
+}
+
+constexpr bool namedColoursDistinct(uint8_t nLevel, uint8_t nColour)
+{
+    return (nLevel >= BRIGHTNESS_LEVELS) ? true
+        : (nColour >= NAMED_COLOUR_COUNT) ? namedColoursDistinct(nLevel + 1U, 0U)
+        : (namedColourUnique(nLevel, nColour, nColour + 1U) && namedColoursDistinct(nLevel, nColour + 1U));
+}
+
+static_assert(brightnessTableValid(0U), "Brightness levels must only dim, keep black black & rise with level and value");
+static_assert(brightnessFullScale(0U), "Full brightness spreads the 4-bit colours over the driver's whole 5-bit range");
+static_assert(namedColoursDistinct(0U, 0U), "Two named colours look the same at some brightness level");
+
+#endif //LED_BULLETIN_BOARD_COLOUR_PALETTE_H
@@ -6,6 +6,10 @@
 #define LED_BULLETIN_BOARD_GRAPHIC_BITMASKS_H
 
 
+/* Every bitmap covers one 64x32 tile */
+#define BITMAP_WIDTH    64U
+#define BITMAP_HEIGHT   32U
+
 /* Pixel writing created at https://www.pixilart.com/draw & bit-mapped at https://javl.github.io/image2cpp/ */
 const unsigned char youre_done_bitmap [] PROGMEM =
 {
@@ -3,25 +3,40 @@
 #include <P3RGB64x32MatrixPanel.h>
 #include <Fonts/FreeSansBold9pt7b.h>
 #include <string.h>
+#include <time.h>
 #include <WiFiManager.h>
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
 #include <Ticker.h>
 #include <AsyncTCP.h>
 #include "graphic_bitmasks.h"
+#include "time_zone_rules.h"
+#include "text_view.h"
+#include "shadow_panel.h"
+#include "panel_layout.h"
+#include "band_renderer.h"
+#include "colour_palette.h"
+#include "api_fetch.h"
 
 /*=== M A C R O S ===*/
 
-/* Maximum amount of characters on the screen */
-#define MAX_CHAR_WIDTH  11U
-/* Width of each character */
-#define TEXT_WIDTH      6U
-/* Height of each character */
-#define TEXT_HEIGHT     8U
-/* Inversely proportional to the speed of the moving text */
-#define CAROUSEL_DELAY  15U
+/* Speed of the moving text in pixels per second */
+#define CAROUSEL_SPEED  66U
+/* Most pixels the carousel may jump to catch up after an overrun, longer stalls pause the text instead */
+#define CAROUSEL_MAX_SKIP 4U
+/* Print the carousel pacing counters over serial after each message */
+#define CAROUSEL_STATS_ENABLED  0
+/* ESP32's Print::printf() formats into a stack buffer this size, longer output is malloc'd */
+#define PRINTF_STACK_BUFFER     64U
+/* Serial.printf() of a %u-only format, checked at compile time to fit PRINTF_STACK_BUFFER so it never allocates */
+#define STATS_PRINTF(kpcFormat, ...) do { \
+        static_assert(formattedLengthMax(kpcFormat) < PRINTF_STACK_BUFFER, "Stats line would be malloc'd, split it"); \
+        Serial.printf(kpcFormat, __VA_ARGS__); \
+    } while (0)
 /* Converter for milliseconds */
 #define MILLI_SECOND    1000U
+/* Converter for microseconds */
+#define MICRO_SECOND    1000000U
 /* One Milli-minute (60 seconds in milliseconds) */
 #define MILLI_MINUTE    60000U
 /* One Milli-hour (60 minutes in milliminutes) */
@@ -32,6 +47,37 @@
 #define SLEEP_TIME      82800000U
 /* 100 millisecond padding for API calls & Tickers */
 #define TIME_PADDING    100U
+/* How soon to retry an API that had nothing to show */
+#define FETCH_RETRY_INTERVAL    (10U*MILLI_SECOND)
+/* Stream the panel contents over serial for remote preview (decode with tools/panel_mirror.py) */
+#define MIRROR_ENABLED          0
+/* Serial speed, raised while mirroring to carry carousel frame rates */
+#define SERIAL_BAUD             115200U
+#define MIRROR_BAUD             921600U
+/* Mirror frames per second, in step with the carousel so every scroll position reaches the preview (test_mirror
+   checks the carousel's frames fit MIRROR_BAUD at this rate) */
+#define MIRROR_FPS              CAROUSEL_SPEED
+/* Mirror frames between keyframes (whole panel) */
+#define MIRROR_KEYFRAME_PERIOD  (5U*MIRROR_FPS)
+/* Local time zone rules, see time_zone_rules.h */
+#define LOCAL_TIME_ZONE         koTzEuropeDublin
+/* NTP servers for the UTC clock */
+#define NTP_SERVER_1            "pool.ntp.org"
+#define NTP_SERVER_2            "time.google.com"
+/* How long setup waits for the first NTP sync */
+#define NTP_SYNC_TIMEOUT        (10U*MILLI_SECOND)
+/* Any UTC epoch before this (2022-01-01) means the clock hasn't synced yet */
+#define CLOCK_VALID_EPOCH       1640995200
+/* How soon to retry the clock when it hasn't synced */
+#define CLOCK_RETRY_INTERVAL    (MILLI_SECOND)
+/* Print the band renderer's timings over serial after each rainbow bitmap */
+#define RENDER_STATS_ENABLED    0
+/* Tiles the driver underneath can light (the native env's stand-in driver grows with the chain, so only the device is held to this) */
+#ifdef ARDUINO
+#define PANEL_DRIVER_MAX_TILES  1U
+static_assert(PANEL_TILE_COUNT <= PANEL_DRIVER_MAX_TILES,
+              "P3RGB64x32MatrixPanel drives a single 64x32 panel, chained boards need a chain-capable HUB75 driver as the base class");
+#endif
 
 
 /*=== P R O T O T Y P E S ===*/
@@ -41,18 +87,28 @@ void core1Loop(void *unused);
 void causeTime();
 void causeNightTime();
 void drawDateAndTimeChars();
-void drawHourglass(const uint8_t knLeftX, const uint8_t knTopY, const uint8_t knWidth, const uint8_t knHeight);
-void fillHourglass(const uint8_t knFillState);
-void printToScreen(const String ksMessage, const uint16_t knColour, const uint8_t knNumChars, const uint8_t knRow, const int knCursorCol, const uint8_t knClearCol);
-void inline printToScreen(const String ksMessage, const uint16_t knColour, const uint8_t knNumChars, const uint8_t knRow, const int knCol);
+template <uint8_t R> void drawHourglass();
+template <uint8_t R> void fillHourglass(const uint8_t knFillState);
+void printToScreen(const text_view koMessage, const uint16_t knColour, const uint8_t knNumChars, const uint8_t knRow, const int knCursorCol, const uint8_t knClearCol);
+void inline printToScreen(const text_view koMessage, const uint16_t knColour, const uint8_t knNumChars, const uint8_t knRow, const int knCol);
+template <uint8_t R> void printToRegion(const text_view koMessage, const uint16_t knColour, const int16_t knScroll = 0);
 void printRainbowBitmap(const unsigned char bitmap[], const uint16_t nCycles);
+void fillRainbowBand(uint16_t (*panFrame)[PANEL_WIDTH], const panel_rect &koBand, void *pvJob);
+void printRenderStats();
 long HSBtoRGB(float _hue);
-void setDateAndTime();
-void blankAndDrawTime();
-uint8_t compareStrings(String Str1, String Str2);
-String lengthenStrings(String Str1);
-void cycleMessage(const String ksMessage, const uint8_t knRow, const uint32_t knTextDelay);
-void GetAPIRequestJSON(const String ksURL);
+bool getUTCTime(int64_t &nUTC);
+void setDateAndTime(const local_time &koNow);
+void blankAndDrawTime(const local_time &koNow);
+uint8_t scheduledBrightness(const local_time &koNow);
+void applyScheduledBrightness(const local_time &koNow);
+void cycleMessage(const text_view koMessage, const uint32_t knPixelsPerSecond);
+void printCarouselStats();
+void mirrorLoop(void *unused);
+void printMirrorStats();
+fetch_result GetAPIRequestJSON(api_endpoint &oEndpoint);
+int httpRequest(const char *kpcURL, const uint32_t knTimeout, void *pvHTTP);
+int httpRead(uint8_t *pnBuffer, const size_t knSize, const uint32_t knTimeout, void *pvHTTP);
+void httpEnd(void *pvHTTP);
 void createPizza(uint8_t nXMid, uint8_t nYMid);
 void removeCircularSegment(uint8_t nTopLeftCol, uint8_t nTopLeftRow, uint8_t nWidth, uint8_t nHeight, double nFraction);
 void rotateThroughTheta(uint8_t *x, uint8_t *y, uint8_t ox, uint8_t oy, double theta);
@@ -76,16 +132,44 @@ enum ESP32Cores {
 /*=== S T R U C T S ===*/
 
 typedef struct TODO_TASKS {
-    String      sLine1;             /* Text line 1 of the task */
-    String      sLine2;             /* Text line 2 of the task */
+    const char *kpcLine1;           /* Text line 1 of the task */
+    const char *kpcLine2;           /* Text line 2 of the task */
     uint32_t    nMinsToComplete;    /* Time it takes to Complete (in minutes) */
     int8_t      nNumRepeats;        /* Number of times this can repeat in a day, (-1 infinite) */
 } todo_tasks;
 
+typedef struct CAROUSEL_STATS {
+    uint32_t    nFrames;            /* Carousel frames drawn since boot */
+    uint32_t    nMissedDeadlines;   /* Frames that were still drawing when the next frame was due */
+    uint32_t    nSkippedPixels;     /* Pixels jumped over to catch up after an overrun */
+    uint32_t    nLastJitterUs;      /* How late the most recent frame woke up (microseconds) */
+    uint32_t    nMaxJitterUs;       /* Latest wake-up seen since boot (microseconds) */
+} carousel_stats;
+
+typedef struct MIRROR_STATS {
+    uint32_t    nFrames;            /* Mirror frames sent */
+    uint32_t    nKeyframes;         /* Of which keyframes */
+    uint32_t    nBytes;             /* Bytes sent */
+    uint32_t    nLastEncodeUs;      /* Time the last frame held the matrix for encoding (microseconds) */
+    uint32_t    nMaxEncodeUs;       /* Longest the matrix was held for encoding (microseconds) */
+} mirror_stats;
+
+typedef struct BRIGHTNESS_STEP {
+    uint8_t     nHour;              /* Local hour the step starts */
+    uint8_t     nMinute;            /* Local minute the step starts */
+    uint8_t     nLevel;             /* BrightnessLevels from then on */
+} brightness_step;
+
+typedef struct RAINBOW_JOB {
+    const unsigned char *kpnBitmap;     /* Bitmap to draw, centred on the board */
+    uint16_t            n444;           /* Colour of the set bits this frame (0x0RGB) */
+} rainbow_job;
+
 /*=== D A T A ===*/
 
 
-const todo_tasks kaoTasksArray[13U] =
+/* Task text & table both live in flash */
+const todo_tasks kaoTasksArray[13U] PROGMEM =
 {
     {
         " Smile",   "  :D",     3U,  -1
@@ -116,41 +200,58 @@ const todo_tasks kaoTasksArray[13U] =
     }
 };
 
-/* Create two task objects */
-TaskHandle_t Task1, Task2;
+/* Bitmaps are one tile, centred on larger boards; only this window is rendered, so a frame costs the same on any board */
+constexpr panel_rect koRainbowWindow = {(PANEL_WIDTH - BITMAP_WIDTH) / 2U, (PANEL_HEIGHT - BITMAP_HEIGHT) / 2U, BITMAP_WIDTH, BITMAP_HEIGHT};
+
+/* Panel brightness through the day, in order; the last step carries on past midnight */
+const brightness_step kaoBrightnessSchedule[] =
+{
+    {7U,  0U,  BRIGHTNESS_70},     /* Gentle on waking */
+    {8U,  0U,  BRIGHTNESS_100},
+    {18U, 0U,  BRIGHTNESS_85},
+    {20U, 0U,  BRIGHTNESS_55},
+    {21U, 30U, BRIGHTNESS_40},
+    {22U, 30U, BRIGHTNESS_30}      /* Until the nighttime sleep */
+};
+
+/* Create the task objects */
+TaskHandle_t Task1, Task2, Task3;
 /* Declare a Mutex */
 SemaphoreHandle_t oLEDMatrixMutex;
 
 /* WiFiManager, Local intialization. Once its business is done, there is no need to keep it around */
 WiFiManager wm;
 
-/* String for storing server response */
-String response = "";
 /* JSON document */
 DynamicJsonDocument doc(2048);
 
 /* Affirmations website */
-const String ksAffirmRequest = "https://www.affirmations.dev/";
-/* Time & date website */
-const String ksTimeRequest = "https://www.timeapi.io/api/Time/current/zone?timeZone=Europe/Dublin";
+api_endpoint oAffirmEndpoint = {"https://www.affirmations.dev/", "", 0U, 0U};
 
-/* Default pin wiring constructor */
-P3RGB64x32MatrixPanel matrix;
+/* Default pin wiring constructor, keeping a shadow of the panel for mirroring */
+ShadowMatrixPanel matrix;
+/* Frame renderer, filling row bands on both cores */
+BandRenderer oBandRenderer;
 /* Custom pin wiring constructor */
-/* P3RGB64x32MatrixPanel matrix(25, 26, 27, 21, 22, 23, 15, 32, 33, 12, 16, 17, 18); */
-
-/* Colour Declarations */
-uint16_t nBlack  = matrix.color444(0, 0, 0);
-uint16_t nBlue   = matrix.color444(0, 0, 15);
-uint16_t nGreen  = matrix.color444(0, 15, 0);
-uint16_t nRed    = matrix.color444(15, 0, 0);
-uint16_t nYellow = matrix.color444(15, 15, 0);
-uint16_t nCyan   = matrix.color444(0, 15, 15);
-uint16_t nPurple = matrix.color444(15, 0, 15);
-uint16_t nWhite  = matrix.color444(15, 15, 15);
-uint16_t nGrey = matrix.color444(4U, 4U, 4U);
-uint16_t nBrown = matrix.color444(2U, 2U, 0);
-uint16_t nTODO   = matrix.color444(0, 5, 15);
+/* ShadowMatrixPanel matrix(25, 26, 27, 21, 22, 23, 15, 32, 33, 12, 16, 17, 18); */
+
+/* Colour Declarations, shown through the panel's current brightness table */
+uint16_t nBlack  = matrix.from444(COLOUR_BLACK);
+uint16_t nBlue   = matrix.from444(COLOUR_BLUE);
+uint16_t nGreen  = matrix.from444(COLOUR_GREEN);
+uint16_t nRed    = matrix.from444(COLOUR_RED);
+uint16_t nYellow = matrix.from444(COLOUR_YELLOW);
+uint16_t nCyan   = matrix.from444(COLOUR_CYAN);
+uint16_t nPurple = matrix.from444(COLOUR_PURPLE);
+uint16_t nWhite  = matrix.from444(COLOUR_WHITE);
+uint16_t nGrey   = matrix.from444(COLOUR_GREY);
+uint16_t nBrown  = matrix.from444(COLOUR_BROWN);
+uint16_t nTODO   = matrix.from444(COLOUR_TODO);
+
+/* Carousel frame pacing counters, written by core 1 */
+carousel_stats oCarouselStats = {0U, 0U, 0U, 0U, 0U};
+/* Mirror overhead counters, written by the mirror task */
+mirror_stats oMirrorStats = {0U, 0U, 0U, 0U, 0U};
 
 /* Setting up the Clock ticker & nighttime ticker */
 Ticker oTimeTicker(causeTime, MILLI_SECOND);
@@ -161,7 +262,7 @@ Ticker oNightTicker(causeNightTime, 10*MILLI_MINUTE, 1, MILLIS);
 void setup()
 {
     /* Set up serial comms */
-    Serial.begin(115200);
+    Serial.begin(MIRROR_ENABLED ? MIRROR_BAUD : SERIAL_BAUD);
 
     /* Create the Mutex */
     oLEDMatrixMutex = xSemaphoreCreateMutex();
@@ -178,15 +279,17 @@ void setup()
         Serial.println("Connection Successful");
     }
 
-    /* Begin LED matrix */
+    /* Begin LED matrix, with the frame renderer's helper band on the carousel core */
     matrix.begin();
+    oBandRenderer.begin(&matrix, CORE_1);
 
     /* Blanking & Text configuration */
+    xSemaphoreTake(oLEDMatrixMutex, portMAX_DELAY);
     matrix.fillScreen(nBlack);
     matrix.setTextSize(1);     // size 1 == 8 pixels high
     matrix.setTextWrap(false); // Don't wrap at end of line - will do ourselves
+    xSemaphoreGive(oLEDMatrixMutex);
 
-    matrix.
     /* Draw a pizza (with 6 slices) in the middle-left area of the LED matrix */
 //    createPizza(8U, 16U);
 //    double nFraction = 1.0 / 6.0, nCircuit = 360.0;
@@ -195,21 +298,35 @@ void setup()
 //    }
 //    matrix.fillRect(0U, 8U, 17U, 16U, nBlack);
 
-//    drawHourglass(0U,9U,17U, 15U);
-//    fillHourglass(0U);
+//    drawHourglass<REGION_GRAPHIC>();
+//    fillHourglass<REGION_GRAPHIC>(0U);
 
     /* Draw the essential characters onto the panel */
     drawDateAndTimeChars();
 
     /* Start the periodic Core 0 Time-tracking Ticker */
     oTimeTicker.start();
-    /* Get the time for the nighttime timer from timeapi.io */
-    GetAPIRequestJSON(ksTimeRequest);
+    /* Start the UTC clock & wait (briefly) for the first NTP sync for the nighttime timer */
+    configTime(0, 0, NTP_SERVER_1, NTP_SERVER_2);
+    int64_t nUTC;
+    const uint32_t knSyncStart = millis();
+    while (!getUTCTime(nUTC) && ((millis() - knSyncStart) < NTP_SYNC_TIMEOUT)) {
+        delay(TIME_PADDING);
+    }
     /* Start the Core 0 nighttime Ticker */
     oNightTicker.start();
-    /* Schedule the next ticker call to at sleep time or now, if it's already nighttime */
-    int32_t nTimeTilNight = SLEEP_TIME - ((MILLI_HOUR * doc["hour"].as<int>()) + (MILLI_MINUTE * doc["minute"].as<int>()));
-    oNightTicker.interval((nTimeTilNight > 0) ? (nTimeTilNight) : (TIME_PADDING));
+    if (!getUTCTime(nUTC)) {
+        /* No idea what time it is, check again later rather than sleeping at a guess */
+        oNightTicker.interval(MILLI_HOUR);
+    }
+    else {
+        /* Schedule the next ticker call to at sleep time or now, if it's already nighttime */
+        const local_time koNow = tzToLocalTime(nUTC, LOCAL_TIME_ZONE);
+        const uint32_t knTimeOfDay = (MILLI_HOUR * koNow.nHour) + (MILLI_MINUTE * koNow.nMinute);
+        const bool kbNight = (knTimeOfDay >= SLEEP_TIME) || (knTimeOfDay < WAKE_TIME);
+        const int64_t knTimeTilNight = tzNextLocalTime(nUTC, LOCAL_TIME_ZONE, SLEEP_TIME / MILLI_SECOND) - nUTC;
+        oNightTicker.interval(kbNight ? (TIME_PADDING) : ((uint32_t)knTimeTilNight * MILLI_SECOND));
+    }
 
     /* Assigning tasks to each core */
     xTaskCreatePinnedToCore(core0Loop,  /* Function to implement the task */
@@ -220,6 +337,10 @@ void setup()
                             &Task1,     /* Task handle. */
                             CORE_0);    /* Core where the task should run */
     xTaskCreatePinnedToCore(core1Loop, "AffirmTask", 5000, NULL, 2, &Task2, CORE_1);
+#if MIRROR_ENABLED
+    /* Mirror at a lower priority on the time core, away from the carousel */
+    xTaskCreatePinnedToCore(mirrorLoop, "MirrorTask", 3000, NULL, 1, &Task3, CORE_0);
+#endif
 }
 
 void loop()
@@ -231,7 +352,7 @@ void loop()
  */
 void core0Loop(void *unused)
 {
-    uint8_t i = 0;
+//    uint8_t i = 0;
     /* Core 0 loop */
     for(;;)
     {
@@ -245,8 +366,8 @@ void core0Loop(void *unused)
 //        {
 //            i = 0U;
 //        }
-//        printToScreen(kaoTasksArray[i].sLine1, nTODO, 8U, ROW_1*TEXT_HEIGHT, 17U);
-//        printToScreen(kaoTasksArray[i].sLine2, nTODO, 8U, ROW_2*TEXT_HEIGHT, 17U);
+//        printToRegion<REGION_TODO_LINE_1>(textViewOf(kaoTasksArray[i].kpcLine1), nTODO);
+//        printToRegion<REGION_TODO_LINE_2>(textViewOf(kaoTasksArray[i].kpcLine2), nTODO);
 //        i++;
 //        delay(2000U);
     }
@@ -260,25 +381,121 @@ void core1Loop(void *unused)
 {
     /* Core 1 loop */
     for(;;) {
-        GetAPIRequestJSON(ksAffirmRequest);
-        /* Message converted to string */
-        String sMessage = doc["affirmation"].as<char*>();
-        cycleMessage(sMessage, ROW_3, CAROUSEL_DELAY);
+        if (GetAPIRequestJSON(oAffirmEndpoint) == FETCH_NONE) {
+            /* Nothing to show yet */
+            delay(FETCH_RETRY_INTERVAL);
+            continue;
+        }
+        /* View straight into the JSON document, which only this core rewrites */
+        cycleMessage(textViewOf(doc["affirmation"].as<const char*>()), CAROUSEL_SPEED);
+#if CAROUSEL_STATS_ENABLED
+        printCarouselStats();
+#endif
+#if MIRROR_ENABLED
+        printMirrorStats();
+#endif
         delay(1);
     }
 }
 
 /**
- * Requests the current time & date, shows it on display and schedules next update
+ * Mirror loop - Streams changed panel spans over serial at MIRROR_FPS
+ * @param unused
+ */
+void mirrorLoop(void *unused)
+{
+    static uint8_t anFrame[MIRROR_MAX_FRAME_SIZE];
+    TickType_t nLastWake = xTaskGetTickCount();
+    uint32_t nFrame = 0U;
+
+    for(;;) {
+        const bool kbKeyframe = ((nFrame++ % MIRROR_KEYFRAME_PERIOD) == 0U);
+
+        /* Only hold the matrix long enough to encode, the serial write happens after */
+        xSemaphoreTake(oLEDMatrixMutex, portMAX_DELAY);
+        const uint32_t knStart = micros();
+        const uint16_t knSize = matrix.encodeMirrorFrame(anFrame, kbKeyframe);
+        oMirrorStats.nLastEncodeUs = micros() - knStart;
+        xSemaphoreGive(oLEDMatrixMutex);
+        oMirrorStats.nMaxEncodeUs = max(oMirrorStats.nMaxEncodeUs, oMirrorStats.nLastEncodeUs);
+
+        if (knSize > 0U) {
+            /* One write per frame so other serial output can't split it */
+            Serial.write(anFrame, knSize);
+            oMirrorStats.nFrames++;
+            oMirrorStats.nKeyframes += kbKeyframe ? 1U : 0U;
+            oMirrorStats.nBytes += knSize;
+        }
+        vTaskDelayUntil(&nLastWake, pdMS_TO_TICKS(MILLI_SECOND / MIRROR_FPS));
+    }
+}
+
+/**
+ * Reads the current time & date, shows it on display and schedules next update
  */
 void causeTime()
 {
-    /* Get the time and date from timeapi.io */
-    GetAPIRequestJSON(ksTimeRequest);
+    int64_t nUTC;
+    if (!getUTCTime(nUTC)) {
+        /* NTP hasn't synced yet, retry shortly */
+        oTimeTicker.interval(CLOCK_RETRY_INTERVAL);
+        return;
+    }
+    const local_time koNow = tzToLocalTime(nUTC, LOCAL_TIME_ZONE);
     /* Schedule the next update for just after the next minute */
-    oTimeTicker.interval(MILLI_MINUTE - (MILLI_SECOND * doc["seconds"].as<int>()) + TIME_PADDING);
+    oTimeTicker.interval(MILLI_MINUTE - (MILLI_SECOND * koNow.nSecond) + TIME_PADDING);
     /* Set the time and date on the display */
-    setDateAndTime();
+    setDateAndTime(koNow);
+    /* Step the whole panel's brightness if the schedule has moved on */
+    applyScheduledBrightness(koNow);
+}
+
+/**
+ * Looks up the panel brightness for a time of day
+ * @param koNow Local time
+ * @return      BrightnessLevels
+ */
+uint8_t scheduledBrightness(const local_time &koNow)
+{
+    const uint16_t knMinuteOfDay = (60U * koNow.nHour) + koNow.nMinute;
+    const uint8_t knSteps = sizeof(kaoBrightnessSchedule) / sizeof(kaoBrightnessSchedule[0]);
+    /* Before the first step it's still the previous day's last */
+    uint8_t nLevel = kaoBrightnessSchedule[knSteps - 1U].nLevel;
+    for (uint8_t i = 0U; i < knSteps; i++)
+    {
+        if (((60U * kaoBrightnessSchedule[i].nHour) + kaoBrightnessSchedule[i].nMinute) > knMinuteOfDay) {
+            break;
+        }
+        nLevel = kaoBrightnessSchedule[i].nLevel;
+    }
+    return nLevel;
+}
+
+/**
+ * Swaps the panel onto the scheduled brightness table, no widget needs to redraw
+ * @param koNow Local time
+ */
+void applyScheduledBrightness(const local_time &koNow)
+{
+    const uint8_t knLevel = scheduledBrightness(koNow);
+    /* Only this core changes the brightness */
+    if (knLevel == matrix.brightness()) {
+        return;
+    }
+    xSemaphoreTake(oLEDMatrixMutex, portMAX_DELAY);
+    matrix.setBrightness(knLevel);
+    xSemaphoreGive(oLEDMatrixMutex);
+}
+
+/**
+ * Reads the UTC clock kept by NTP
+ * @param nUTC Seconds since 1970-01-01 UTC
+ * @return     Whether the clock has synced
+ */
+bool getUTCTime(int64_t &nUTC)
+{
+    nUTC = (int64_t)time(nullptr);
+    return (nUTC >= CLOCK_VALID_EPOCH);
 }
 
 /**
@@ -287,33 +504,45 @@ void causeTime()
 void causeNightTime()
 {
     /* Nighty-Night */
-    int32_t nTimeTilWake;
-    uint32_t nTimeTilNextCycle;
+    int64_t nUTC;
+    if (!getUTCTime(nUTC)) {
+        /* Still no idea what time it is, don't sleep at a guess */
+        oNightTicker.interval(MILLI_HOUR);
+        oNightTicker.start();
+        return;
+    }
+
+    /* Get the current local time in milliseconds */
+    const local_time koNow = tzToLocalTime(nUTC, LOCAL_TIME_ZONE);
+    const uint32_t knTimeOfDay = (MILLI_HOUR * koNow.nHour) + (MILLI_MINUTE * koNow.nMinute);
+    if ((knTimeOfDay >= WAKE_TIME) && (knTimeOfDay < (SLEEP_TIME - MILLI_MINUTE))) {
+        /* Scheduled without knowing the time and it's still daytime, try again at sleep time */
+        oNightTicker.interval(SLEEP_TIME - knTimeOfDay);
+        oNightTicker.start();
+        return;
+    }
 
     /* Blank the screen & print the nighttime message */
     xSemaphoreTake(oLEDMatrixMutex, portMAX_DELAY);
     matrix.fillScreen(nBlack);
-    String nNightTimeMessageRow1 = "Night";
-    String nNightTimeMessageRow2 = "  :)";
+    const text_view koNightTimeMessageRow1 = textView("Night");
+    const text_view koNightTimeMessageRow2 = textView("  :)");
     matrix.setTextSize(2);
     xSemaphoreGive(oLEDMatrixMutex);
     /* Offset messages to give 3D effect */
-    printToScreen(nNightTimeMessageRow1, nRed, 0U, ROW_0*TEXT_HEIGHT+1U, 2U);
-    printToScreen(nNightTimeMessageRow2, nRed, 0U, ROW_2*TEXT_HEIGHT+1U, 2U);
-    printToScreen(nNightTimeMessageRow1, nPurple, 0U, ROW_0*TEXT_HEIGHT, 3U);
-    printToScreen(nNightTimeMessageRow2, nPurple, 0U, ROW_2*TEXT_HEIGHT, 3U);
+    printToScreen(koNightTimeMessageRow1, nRed, 0U, ROW_0*TEXT_HEIGHT+1U, 2U);
+    printToScreen(koNightTimeMessageRow2, nRed, 0U, ROW_2*TEXT_HEIGHT+1U, 2U);
+    printToScreen(koNightTimeMessageRow1, nPurple, 0U, ROW_0*TEXT_HEIGHT, 3U);
+    printToScreen(koNightTimeMessageRow2, nPurple, 0U, ROW_2*TEXT_HEIGHT, 3U);
     xSemaphoreTake(oLEDMatrixMutex, portMAX_DELAY);
     delay(5000U);
     xSemaphoreGive(oLEDMatrixMutex);
 
-    /* Get the current time in milliseconds */
-    nTimeTilWake = ((MILLI_HOUR * doc["hour"].as<int>()) + (MILLI_MINUTE * doc["minute"].as<int>()));
-    /* Get the offset between now & wakeup time : assert if it's the day before or the same day as wakeup time */
-    nTimeTilWake = (nTimeTilWake > WAKE_TIME) ? (nTimeTilWake - (24U * MILLI_HOUR)) : (nTimeTilWake);
-    /* Schedule the ESP wakeup at WAKE_TIME */
-    nTimeTilNextCycle = WAKE_TIME - nTimeTilWake;
+    /* Schedule the ESP wakeup at the next local WAKE_TIME, which may be across a DST change */
+    getUTCTime(nUTC);
+    const int64_t knTimeTilWake = tzNextLocalTime(nUTC, LOCAL_TIME_ZONE, WAKE_TIME / MILLI_SECOND) - nUTC;
     /* Time in microseconds */
-    esp_sleep_enable_timer_wakeup(nTimeTilNextCycle*1000U);
+    esp_sleep_enable_timer_wakeup((uint64_t)knTimeTilWake * MICRO_SECOND);
     esp_deep_sleep_start();
 }
 
@@ -322,28 +551,27 @@ void causeNightTime()
  */
 void drawDateAndTimeChars()
 {
+    constexpr layout_region koSeparator = kaoLayout[REGION_DATE_SEPARATOR];
     /* Gain exclusive access to the matrix */
     xSemaphoreTake(oLEDMatrixMutex, portMAX_DELAY);
     /* Draw date '|' character */
-    matrix.drawLine(TEXT_WIDTH*2U, 0U, TEXT_WIDTH*2U, TEXT_HEIGHT-1U, nYellow);
-    /* Draw time ':' character */
-    matrix.setTextColor(nCyan);
-    matrix.setCursor(64 - TEXT_WIDTH*3U+2, ROW_0);
-    matrix.print(":");
+    matrix.drawFastVLine(koSeparator.nLeft, koSeparator.nTop, koSeparator.nHeight, nYellow);
     /* Relinquish exclusive access to the matrix */
     xSemaphoreGive(oLEDMatrixMutex);
+    /* Draw time ':' character */
+    printToRegion<REGION_TIME_SEPARATOR>(textView(":"), nCyan);
 }
 
 /**
  * Prints message to the matrix display
- * @param ksMessage   Message to display
+ * @param koMessage   Message to display
  * @param knColour    Font colour
  * @param knNumChars  Message length
  * @param knRow       Row to print on
  * @param knCursorCol Where in column to print
  * @param knClearCol  Column to clear from.
  */
-void printToScreen(const String ksMessage, const uint16_t knColour, const uint8_t knNumChars, const uint8_t knRow, const int knCursorCol, const uint8_t knClearCol)
+void printToScreen(const text_view koMessage, const uint16_t knColour, const uint8_t knNumChars, const uint8_t knRow, const int knCursorCol, const uint8_t knClearCol)
 {
     /* Gain exclusive access to the matrix */
     xSemaphoreTake(oLEDMatrixMutex, portMAX_DELAY);
@@ -352,27 +580,55 @@ void printToScreen(const String ksMessage, const uint16_t knColour, const uint8_
     matrix.fillRect(knClearCol, knRow, TEXT_WIDTH*knNumChars, TEXT_HEIGHT, nBlack);
     /* Position the cursor at the input position & print message */
     matrix.setCursor(knCursorCol, knRow);
-    matrix.print(ksMessage);
+    matrix.write((const uint8_t *)koMessage.kpcData, koMessage.nLength);
     /* Relinquish exclusive access to the matrix */
     xSemaphoreGive(oLEDMatrixMutex);
 }
 
 /**
  * (Overload) Prints message to the matrix display
- * @param ksMessage   Message to display
+ * @param koMessage   Message to display
  * @param knColour    Font colour
  * @param knNumChars  Message length
  * @param knRow       Row to print on
  * @param knCursorCol Where in column to print, which is also cleared
  */
-void inline printToScreen(const String ksMessage, const uint16_t knColour, const uint8_t knNumChars, const uint8_t knRow, const int knCol)
+void inline printToScreen(const text_view koMessage, const uint16_t knColour, const uint8_t knNumChars, const uint8_t knRow, const int knCol)
 {
     /* Overloaded function with one column value */
-    printToScreen(ksMessage, knColour, knNumChars, knRow, knCol, knCol);
+    printToScreen(koMessage, knColour, knNumChars, knRow, knCol, knCol);
 }
 
 /**
- * Prints bitmap in a rainbow fashion
+ * Prints message into a layout region, clearing & clipping to that region only.
+ * The region is a template parameter so its coordinates compile down to constants.
+ * @param koMessage Message to display
+ * @param knColour  Font colour
+ * @param knScroll  Text offset from the region's cursor position (for scrolling)
+ */
+template <uint8_t R>
+void printToRegion(const text_view koMessage, const uint16_t knColour, const int16_t knScroll)
+{
+    static_assert(R < REGION_COUNT, "Unknown layout region");
+    constexpr layout_region koRegion = kaoLayout[R];
+
+    /* Gain exclusive access to the matrix */
+    xSemaphoreTake(oLEDMatrixMutex, portMAX_DELAY);
+    /* Nothing outside the region gets touched */
+    matrix.setClipRect(koRegion.nLeft, koRegion.nTop, koRegion.nWidth, koRegion.nHeight);
+    matrix.fillRect(koRegion.nLeft, koRegion.nTop, koRegion.nWidth, koRegion.nHeight, nBlack);
+    /* Position the cursor in the region & print message */
+    matrix.setTextColor(knColour);
+    matrix.setCursor(koRegion.nLeft + koRegion.nCursorOffset + knScroll, koRegion.nTop);
+    matrix.write((const uint8_t *)koMessage.kpcData, koMessage.nLength);
+    matrix.clearClipRect();
+    /* Relinquish exclusive access to the matrix */
+    xSemaphoreGive(oLEDMatrixMutex);
+}
+
+/**
+ * Prints bitmap in a rainbow fashion, on a board the caller has blanked.
+ * Each frame is filled in two row bands of the bitmap's window, one per core, and flushed once.
  * @param bitmap  Bitmap to print
  * @param nCycles How many times the display should rainbow cycle
  */
@@ -381,20 +637,56 @@ void printRainbowBitmap(const unsigned char bitmap[], const uint16_t nCycles)
     /* Gain exclusive access to the matrix */
     xSemaphoreTake(oLEDMatrixMutex, portMAX_DELAY);
 
-    uint16_t nColour;
+    rainbow_job oJob = {bitmap, 0U};
     long nColourPicked;
 
     for (uint16_t i = 0U; i < nCycles; i++)
     {
         /* Draw the bitmap while shifting the hue */
         nColourPicked = HSBtoRGB((float(i%64U)/64U)*360.0);
-        nColour = matrix.color444((nColourPicked >> 8U) & 0xFU, (nColourPicked >> 4U) & 0xFU, (nColourPicked) & 0xFU);
-        matrix.drawBitmap(0U, 0U, bitmap, 64U, 32U, nColour);
+        oJob.n444 = (uint16_t)(nColourPicked & 0xFFFU);
+        oBandRenderer.renderFrame(fillRainbowBand, &oJob, koRainbowWindow);
         delay(15);
     }
 
     /* Relinquish exclusive access to the matrix */
     xSemaphoreGive(oLEDMatrixMutex);
+#if RENDER_STATS_ENABLED
+    printRenderStats();
+#endif
+}
+
+/**
+ * Fills a band of a rainbow bitmap frame; set bits take the job's colour, clear ones are blank
+ * @param panFrame Frame to fill (0x0RGB)
+ * @param koBand   Rows of koRainbowWindow to fill
+ * @param pvJob    rainbow_job
+ */
+void fillRainbowBand(uint16_t (*panFrame)[PANEL_WIDTH], const panel_rect &koBand, void *pvJob)
+{
+    const rainbow_job *kpoJob = (const rainbow_job *)pvJob;
+
+    for (uint8_t y = koBand.nTop; y < (koBand.nTop + koBand.nHeight); y++)
+    {
+        const uint8_t knBitmapRow = y - koRainbowWindow.nTop;
+        for (uint8_t x = koBand.nLeft; x < (koBand.nLeft + koBand.nWidth); x++)
+        {
+            const uint8_t knBitmapCol = x - koRainbowWindow.nLeft;
+            const uint8_t knByte = pgm_read_byte(&kpoJob->kpnBitmap[knBitmapRow * (BITMAP_WIDTH / 8U) + knBitmapCol / 8U]);
+            panFrame[y][x] = (knByte & (0x80U >> (knBitmapCol & 7U))) ? kpoJob->n444 : 0U;
+        }
+    }
+}
+
+/**
+ * Prints the band renderer's timings over serial
+ */
+void printRenderStats()
+{
+    STATS_PRINTF("Render: %u frames\n", oBandRenderer.oStats.nFrames);
+    STATS_PRINTF("Render: fill %u us, wait %u us\n", oBandRenderer.oStats.nLastFillUs, oBandRenderer.oStats.nLastWaitUs);
+    STATS_PRINTF("Render: flush %u us (%u of %u px)\n", oBandRenderer.oStats.nLastFlushUs, oBandRenderer.oStats.nLastFlushPixels,
+                 oBandRenderer.oStats.nLastWindowPixels);
 }
 
 /**
@@ -460,186 +752,261 @@ long HSBtoRGB(float _hue) {
 }
 
 /**
- * Sets data and time based on prior API request.
+ * Sets date and time on the display.
  * Also Displays messages at lunch/ quittin' time(s)
+ * @param koNow Current local time
  */
-void setDateAndTime()
+void setDateAndTime(const local_time &koNow)
 {
-    static String sPreviousDay="", sPreviousMonth="", sPreviousHour="", sPreviousMin="", sPreviousDoW="";
-    String sNewDay, sNewMonth, sNewHour, sNewMin, sNewDoW;
-
-    sNewDay   = doc["day"].as<int>();
-    sNewMonth = doc["month"].as<int>();
-    sNewHour  = doc["hour"].as<int>();
-    sNewMin   = doc["minute"].as<int>();
-    sNewDoW   = doc["dayOfWeek"].as<char*>();
+    /* Out-of-range start values force the first draw */
+    static uint8_t nPreviousDay = UINT8_MAX, nPreviousMonth = UINT8_MAX, nPreviousHour = UINT8_MAX, nPreviousMin = UINT8_MAX;
 
     /* Work's Done! */
-    if ((sNewHour == "17") && (sNewMin == "30") && (sNewDoW[0] != 'S'))
+    if ((koNow.nHour == 17U) && (koNow.nMinute == 30U) && (koNow.nDayOfWeek != TZ_SATURDAY) && (koNow.nDayOfWeek != TZ_SUNDAY))
     {
         /* Blank the screen & print the celebration */
+        xSemaphoreTake(oLEDMatrixMutex, portMAX_DELAY);
         matrix.fillScreen(nBlack);
+        xSemaphoreGive(oLEDMatrixMutex);
         printRainbowBitmap(youre_done_bitmap, 500U);
-        blankAndDrawTime();
+        blankAndDrawTime(koNow);
         /* Update stored variables */
-        sPreviousDay = sNewDay;
-        sPreviousMonth = sNewMonth;
-        sPreviousHour = sNewHour;
-        sPreviousMin = sNewMin;
+        nPreviousDay = koNow.nDay;
+        nPreviousMonth = koNow.nMonth;
+        nPreviousHour = koNow.nHour;
+        nPreviousMin = koNow.nMinute;
     }
     /* Lunch time! */
-    else if ((sNewHour == "13") && (sNewMin == "0"))
+    else if ((koNow.nHour == 13U) && (koNow.nMinute == 0U))
     {
         /* Blank the screen & print the celebration */
+        xSemaphoreTake(oLEDMatrixMutex, portMAX_DELAY);
         matrix.fillScreen(nBlack);
+        xSemaphoreGive(oLEDMatrixMutex);
         printRainbowBitmap(lunch_time_bitmap, 500U);
-        blankAndDrawTime();
+        blankAndDrawTime(koNow);
         /* Update stored variables */
-        sPreviousDay = sNewDay;
-        sPreviousMonth = sNewMonth;
-        sPreviousHour = sNewHour;
-        sPreviousMin = sNewMin;
+        nPreviousDay = koNow.nDay;
+        nPreviousMonth = koNow.nMonth;
+        nPreviousHour = koNow.nHour;
+        nPreviousMin = koNow.nMinute;
     }
     else {
         /* Regular update of date & time */
-        if (compareStrings(sPreviousDay, sNewDay) != 0U) {
+        if (nPreviousDay != koNow.nDay) {
             /* Blank & set the day zone */
-            printToScreen(lengthenStrings(sNewDay), nYellow, 2U, ROW_0, 0U);
+            printToRegion<REGION_DAY>(padTwoDigits(koNow.nDay).view(), nYellow);
             /* Update the saved value */
-            sPreviousDay = sNewDay;
+            nPreviousDay = koNow.nDay;
         }
-        if (compareStrings(sPreviousMonth, sNewMonth) != 0U) {
+        if (nPreviousMonth != koNow.nMonth) {
             /* Blank & set the month zone */
-            printToScreen(lengthenStrings(sNewMonth), nYellow, 2U, ROW_0, TEXT_WIDTH * 3U - 4U);
+            printToRegion<REGION_MONTH>(padTwoDigits(koNow.nMonth).view(), nYellow);
             /* Update the saved value */
-            sPreviousMonth = sNewMonth;
+            nPreviousMonth = koNow.nMonth;
         }
 
-        if (compareStrings(sPreviousHour, sNewHour) != 0U) {
+        if (nPreviousHour != koNow.nHour) {
             /* Blank & set the hour zone */
-            printToScreen(lengthenStrings(sNewHour), nCyan, 2U, ROW_0, 64U - TEXT_WIDTH * 5U + 4);
+            printToRegion<REGION_HOUR>(padTwoDigits(koNow.nHour).view(), nCyan);
             /* Update the saved value */
-            sPreviousHour = sNewHour;
+            nPreviousHour = koNow.nHour;
         }
-        if (compareStrings(sPreviousMin, sNewMin) != 0U) {
+        if (nPreviousMin != koNow.nMinute) {
             /* Blank & set the minute zone */
-            printToScreen(lengthenStrings(sNewMin), nCyan, 2U, ROW_0, 64U - TEXT_WIDTH * 2U);
+            printToRegion<REGION_MINUTE>(padTwoDigits(koNow.nMinute).view(), nCyan);
             /* Update the saved value */
-            sPreviousMin = sNewMin;
+            nPreviousMin = koNow.nMinute;
         }
     }
 }
 
 /**
  * Clears screen and redraws time & date
+ * @param koNow Current local time
  */
-void blankAndDrawTime()
+void blankAndDrawTime(const local_time &koNow)
 {
     /* Blank the screen & reprint the current date & time */
+    xSemaphoreTake(oLEDMatrixMutex, portMAX_DELAY);
     matrix.fillScreen(nBlack);
+    xSemaphoreGive(oLEDMatrixMutex);
     drawDateAndTimeChars();
-    printToScreen(lengthenStrings(String(doc["day"].as<int>())), nYellow, 2U, ROW_0, 0U);
-    printToScreen(lengthenStrings(String(doc["month"].as<int>())), nYellow, 2U, ROW_0, TEXT_WIDTH * 3U - 4U);
-    printToScreen(lengthenStrings(String(doc["hour"].as<int>())), nCyan, 2U, ROW_0, 64U - TEXT_WIDTH * 5U + 4);
-    printToScreen(lengthenStrings(String(doc["minute"].as<int>())), nCyan, 2U, ROW_0, 64U - TEXT_WIDTH * 2U);
+    printToRegion<REGION_DAY>(padTwoDigits(koNow.nDay).view(), nYellow);
+    printToRegion<REGION_MONTH>(padTwoDigits(koNow.nMonth).view(), nYellow);
+    printToRegion<REGION_HOUR>(padTwoDigits(koNow.nHour).view(), nCyan);
+    printToRegion<REGION_MINUTE>(padTwoDigits(koNow.nMinute).view(), nCyan);
 }
 
 /**
- * Compares 2 strings
- * @param  Str1 String 1
- * @param  Str2 String 2
- * @return  0   : Strings equal
- * @return <0|>0: Strings Unequal
+ * Creates a scrolling carousel in the carousel region displaying a given message.
+ * Frames are paced against absolute deadlines, and the text position is derived from the time elapsed
+ * so the scroll speed doesn't depend on message length, mutex waits or draw cost.
+ * @param koMessage         What message should be displayed
+ * @param knPixelsPerSecond Carousel velocity
  */
-uint8_t compareStrings(String Str1, String Str2)
+void cycleMessage(const text_view koMessage, const uint32_t knPixelsPerSecond)
 {
-    /* very simple string comparison function */
-    const uint8_t knMinSize = (Str1.length() > Str1.length()) ? (Str2.length()) : (Str1.length());
-    if (knMinSize == 0)
-    {
-        return -1;
-    }
-    uint8_t i = 0;
-    while((Str1[i] == Str2[i]) && (i < knMinSize))
+    /* The length of the message in pixels/columns */
+    const int knPixelLength   = ((int)koMessage.nLength*TEXT_WIDTH);
+    /* Start just past the right edge of the region */
+    const int knStartPosition = (int)kaoLayout[REGION_CAROUSEL].nWidth;
+    /* One pixel step per frame, rounded to whole RTOS ticks */
+    const TickType_t knFrameTicks = max((TickType_t)1U, (TickType_t)(configTICK_RATE_HZ / knPixelsPerSecond));
+    const uint32_t knTickMicros   = portTICK_PERIOD_MS * MILLI_SECOND;
+
+    /* Start on a tick edge, so tick deadlines convert to micros() without up to a tick of rounding */
+    vTaskDelay(1);
+    const TickType_t knTickOrigin     = xTaskGetTickCount();
+    const uint32_t knTickOriginMicros = micros();
+    TickType_t nLastWake   = knTickOrigin;
+    uint32_t nOriginMicros = knTickOriginMicros;
+    int nDrawnPos = knStartPosition + 1;
+    int nPos      = knStartPosition;
+
+    /* Runs until the fully scrolled-out frame has been drawn, so no column of text is left behind */
+    while (nDrawnPos > -knPixelLength)
     {
-        i++;
+        if (nPos != nDrawnPos)
+        {
+            if ((nDrawnPos - nPos - 1) > (int)CAROUSEL_MAX_SKIP)
+            {
+                /* Stalled for too long (e.g. a celebration held the matrix), resume from here rather than leaping */
+                nPos = nDrawnPos - 1 - CAROUSEL_MAX_SKIP;
+                nOriginMicros = micros() - (uint32_t)(((uint64_t)(knStartPosition - nPos) * MICRO_SECOND) / knPixelsPerSecond);
+            }
+            /* A jump past the end lands on the last frame instead */
+            nPos = max(nPos, -knPixelLength);
+            /* Count the pixels jumped over to catch up */
+            oCarouselStats.nSkippedPixels += (uint32_t)(nDrawnPos - nPos - 1);
+            /* Print the message */
+            printToRegion<REGION_CAROUSEL>(koMessage, nPurple, nPos);
+            nDrawnPos = nPos;
+            oCarouselStats.nFrames++;
+        }
+
+        const TickType_t knDeadline = nLastWake + knFrameTicks;
+        if ((int32_t)(xTaskGetTickCount() - knDeadline) >= 0)
+        {
+            /* Overran the deadline & this frame is already late: go straight on, next deadline a frame from now */
+            oCarouselStats.nMissedDeadlines++;
+            nLastWake = xTaskGetTickCount();
+        }
+        else
+        {
+            /* Sleep until the absolute deadline of the next frame, which nLastWake then holds */
+            vTaskDelayUntil(&nLastWake, knFrameTicks);
+        }
+
+        /* Record how late we went on, against the tick the frame was due at */
+        const uint32_t knDeadlineMicros = knTickOriginMicros + (uint32_t)(knDeadline - knTickOrigin) * knTickMicros;
+        const int32_t knLateness = (int32_t)(micros() - knDeadlineMicros);
+        oCarouselStats.nLastJitterUs = (knLateness > 0) ? ((uint32_t)knLateness) : (0U);
+        oCarouselStats.nMaxJitterUs  = max(oCarouselStats.nMaxJitterUs, oCarouselStats.nLastJitterUs);
+
+        /* Position follows the elapsed time, not the number of frames drawn */
+        nPos = knStartPosition - (int)(((uint64_t)(micros() - nOriginMicros) * knPixelsPerSecond) / MICRO_SECOND);
     }
-    return Str1[i] - Str2[i];
 }
 
 /**
- * Adds leading zeros to single characters
- * @param Str1 Unpadded String
- * @return     Padded String
+ * Prints the mirror overhead counters over serial (the decoder passes text through)
  */
-String lengthenStrings(String Str1)
+void printMirrorStats()
 {
-    /* Used to add a leading zero to single character time measurements */
-    if (Str1.length() == 1)
-    {
-        return "0" + Str1;
-    }
-    return Str1;
+    STATS_PRINTF("Mirror: %u frames (%u key), %u bytes\n", oMirrorStats.nFrames, oMirrorStats.nKeyframes, oMirrorStats.nBytes);
+    STATS_PRINTF("Mirror encode: %u us (max %u us)\n", oMirrorStats.nLastEncodeUs, oMirrorStats.nMaxEncodeUs);
 }
 
 /**
- * Creates a scrolling carousel displaying a given message/
- * @param ksMessage   What message should be displayed
- * @param knRow       What row to create the carousel on
- * @param knTextDelay Delay between printing each letter (inversely proportional to carousel velocity)
+ * Prints the carousel frame pacing counters over serial
  */
-void cycleMessage(const String ksMessage, const uint8_t knRow, const uint32_t knTextDelay)
+void printCarouselStats()
 {
-    /* The length of the message in pixels/columns */
-    const int knPixelLength   = ((int)ksMessage.length()*TEXT_WIDTH);
-    /* Start at the last character position (just off screen) */
-    const int knStartPosition = ((int)(MAX_CHAR_WIDTH*TEXT_WIDTH));
+    STATS_PRINTF("Carousel: %u frames, %u missed deadlines\n", oCarouselStats.nFrames, oCarouselStats.nMissedDeadlines);
+    STATS_PRINTF("Carousel: %u skipped px\n", oCarouselStats.nSkippedPixels);
+    STATS_PRINTF("Carousel jitter: %u us (max %u us)\n", oCarouselStats.nLastJitterUs, oCarouselStats.nMaxJitterUs);
+}
 
-    for (int nPos = knStartPosition; nPos >= -knPixelLength; nPos--)
+/**
+ * General get request to JSON, over HTTP (see fetchJSON() for the retries, deadline & circuit breaker)
+ * @param oEndpoint target endpoint
+ * @return          Where the data now in doc came from
+ */
+fetch_result GetAPIRequestJSON(api_endpoint &oEndpoint)
+{
+    HTTPClient http;
+    const fetch_transport koTransport = {httpRequest, httpRead, httpEnd, &http};
+    return fetchJSON(oEndpoint, doc, koTransport);
+}
+
+/**
+ * Starts an HTTP GET request, connecting & waiting for the status within the time given
+ * @param kpcURL    Request URL
+ * @param knTimeout Most milliseconds to take
+ * @param pvHTTP    HTTPClient
+ * @return          HTTP status, or a negative HTTPClient error
+ */
+int httpRequest(const char *kpcURL, const uint32_t knTimeout, void *pvHTTP)
+{
+    HTTPClient &http = *(HTTPClient *)pvHTTP;
+    http.setConnectTimeout(min((uint32_t)FETCH_CONNECT_TIMEOUT, knTimeout));
+    http.setTimeout((uint16_t)knTimeout);
+    //HTTP/1.0 keeps the body unchunked, it ends when the server closes
+    http.useHTTP10(true);
+    http.begin(kpcURL);
+    return http.GET();
+}
+
+/**
+ * Reads whatever of the response body has arrived, waiting at most the time given for some
+ * @param pnBuffer  Output
+ * @param knSize    Most bytes to read
+ * @param knTimeout Most milliseconds to wait
+ * @param pvHTTP    HTTPClient
+ * @return          Bytes read, 0 once the server has sent everything, or HTTPC_ERROR_READ_TIMEOUT
+ */
+int httpRead(uint8_t *pnBuffer, const size_t knSize, const uint32_t knTimeout, void *pvHTTP)
+{
+    WiFiClient *poStream = ((HTTPClient *)pvHTTP)->getStreamPtr();
+    const uint32_t knStart = millis();
+    /* Only take what has arrived, Stream::readBytes() would wait out its timeout for every byte of a trickle */
+    while (poStream->available() <= 0)
     {
-        /* Print the message */
-        printToScreen(ksMessage, nPurple, MAX_CHAR_WIDTH, knRow*TEXT_HEIGHT, nPos, 0U);
-        /* How long to wait between printing each column */
-        delay(knTextDelay);
+        if (!poStream->connected()) {
+            return 0;
+        }
+        if ((millis() - knStart) >= knTimeout) {
+            return HTTPC_ERROR_READ_TIMEOUT;
+        }
+        delay(1);
     }
+    return poStream->read(pnBuffer, min((size_t)poStream->available(), knSize));
 }
 
 /**
- * General get request to JSON
- * @param ksURL target URL
+ * Closes the HTTP connection
+ * @param pvHTTP HTTPClient
  */
-void GetAPIRequestJSON(const String ksURL)
+void httpEnd(void *pvHTTP)
 {
-    //Initiate HTTP client
-    HTTPClient http;
-    //Start the request
-    http.begin(ksURL);
-    //Use HTTP GET request
-    http.GET();
-    //Response from server
-    response = http.getString();
-    //Parse JSON, read error if any
-    DeserializationError error = deserializeJson(doc, response);
-    if(error) {
-        Serial.print(F("deserializeJson() failed: "));
-        Serial.println(error.f_str());
-        return;
-    }
-    //Close connection
-    http.end();
+    ((HTTPClient *)pvHTTP)->end();
 }
 
 /**
- * Draws hourglass on matrix
- * @param knLeftX  Leftmost x pos
- * @param knTopY   Topmost y pos
- * @param knWidth  Hourglass width
- * @param knHeight Hourglass height
+ * Draws hourglass filling a layout region
  */
-void drawHourglass(const uint8_t knLeftX, const uint8_t knTopY, const uint8_t knWidth, const uint8_t knHeight)
+template <uint8_t R>
+void drawHourglass()
 {
+    constexpr int16_t knLeftX  = kaoLayout[R].nLeft;
+    constexpr int16_t knTopY   = kaoLayout[R].nTop;
+    constexpr uint8_t knWidth  = kaoLayout[R].nWidth;
+    constexpr uint8_t knHeight = kaoLayout[R].nHeight;
+
     /* Gain exclusive access to the matrix */
     xSemaphoreTake(oLEDMatrixMutex, portMAX_DELAY);
+    matrix.setClipRect(knLeftX, knTopY, knWidth, knHeight);
     /* Draw the hourglass border */
     matrix.drawFastHLine(knLeftX, knTopY, knWidth, nBrown);
     matrix.drawFastHLine(knLeftX, knTopY+knHeight-1U, knWidth, nBrown);
@@ -651,43 +1018,51 @@ void drawHourglass(const uint8_t knLeftX, const uint8_t knTopY, const uint8_t kn
     }
     /* Draw centre horizontal line */
     matrix.drawFastHLine(knLeftX+7U, knTopY+7U, 3U, nGrey);
+    matrix.clearClipRect();
     /* Relinquish exclusive access to the matrix */
     xSemaphoreGive(oLEDMatrixMutex);
 }
 
 /**
- * Fills hourglass to a set level.
+ * Fills hourglass (drawn in the same layout region) to a set level.
  * @param knFillState state of hourglass
  */
+template <uint8_t R>
 void fillHourglass(const uint8_t knFillState)
 {
+    /* Sand is drawn relative to the region's top-left corner */
+    constexpr int16_t knX = kaoLayout[R].nLeft;
+    constexpr int16_t knY = kaoLayout[R].nTop;
+
     /* Gain exclusive access to the matrix */
     xSemaphoreTake(oLEDMatrixMutex, portMAX_DELAY);
+    matrix.setClipRect(knX, knY, kaoLayout[R].nWidth, kaoLayout[R].nHeight);
 
-    uint16_t nSand1 = matrix.color444(15U, 8U, 0);
-    uint16_t nSand2 = matrix.color444(5U, 1U, 0);
+    uint16_t nSand1 = matrix.from444(COLOUR_SAND_1);
+    uint16_t nSand2 = matrix.from444(COLOUR_SAND_2);
 
     /* Draw the top glass full */
-    matrix.fillTriangle(8U, 16U, 5U, 13U, 11U, 13U, nSand1);
-    matrix.drawFastHLine(6U, 12U, 7U, nSand1);
-    matrix.drawFastHLine(7U, 11U, 5U, nSand1);
-    matrix.drawPixel(9U, 12U, nSand2);
-    matrix.drawPixel(10U, 12U, nSand2);
-    matrix.drawPixel(7U, 15U, nSand2);
-    matrix.drawPixel(9U, 14U, nSand2);
+    matrix.fillTriangle(knX+8U, knY+7U, knX+5U, knY+4U, knX+11U, knY+4U, nSand1);
+    matrix.drawFastHLine(knX+6U, knY+3U, 7U, nSand1);
+    matrix.drawFastHLine(knX+7U, knY+2U, 5U, nSand1);
+    matrix.drawPixel(knX+9U, knY+3U, nSand2);
+    matrix.drawPixel(knX+10U, knY+3U, nSand2);
+    matrix.drawPixel(knX+7U, knY+6U, nSand2);
+    matrix.drawPixel(knX+9U, knY+5U, nSand2);
 
     /* Draw the bottom glass full */
-    matrix.fillTriangle(8U, 18U, 12U, 22U, 4U, 22U, nSand1);
-    matrix.drawPixel(8U, 17U, nSand2);
-    matrix.drawPixel(7U, 19U, nSand2);
-    matrix.drawPixel(8U, 20U, nSand2);
-    matrix.drawPixel(10U, 22U, nSand2);
+    matrix.fillTriangle(knX+8U, knY+9U, knX+12U, knY+13U, knX+4U, knY+13U, nSand1);
+    matrix.drawPixel(knX+8U, knY+8U, nSand2);
+    matrix.drawPixel(knX+7U, knY+10U, nSand2);
+    matrix.drawPixel(knX+8U, knY+11U, nSand2);
+    matrix.drawPixel(knX+10U, knY+13U, nSand2);
 
     switch (knFillState) {
         case 0U:
         default:
             break;
     }
+    matrix.clearClipRect();
     /* Relinquish exclusive access to the matrix */
     xSemaphoreGive(oLEDMatrixMutex);
 }
@@ -0,0 +1,58 @@
+//
+// Panel geometry: how many 64x32 tiles make up the board & where each board pixel sits on the chain.
+//
+
+#ifndef LED_BULLETIN_BOARD_PANEL_GEOMETRY_H
+#define LED_BULLETIN_BOARD_PANEL_GEOMETRY_H
+
+#include <stdint.h>
+
+/* Size of one physical panel */
+#define PANEL_TILE_WIDTH    64U
+#define PANEL_TILE_HEIGHT   32U
+
+/* Tiles across & down the board (e.g. -DPANEL_CHAIN_COLS=2 for 128x32, add -DPANEL_CHAIN_ROWS=2 for 128x64) */
+#ifndef PANEL_CHAIN_COLS
+#define PANEL_CHAIN_COLS    1U
+#endif
+#ifndef PANEL_CHAIN_ROWS
+#define PANEL_CHAIN_ROWS    1U
+#endif
+
+/* Board size in pixels */
+#define PANEL_WIDTH         (PANEL_TILE_WIDTH * PANEL_CHAIN_COLS)
+#define PANEL_HEIGHT        (PANEL_TILE_HEIGHT * PANEL_CHAIN_ROWS)
+#define PANEL_TILE_COUNT    (PANEL_CHAIN_COLS * PANEL_CHAIN_ROWS)
+
+/* Mirror frames & spans store coordinates in a byte */
+static_assert((PANEL_WIDTH <= 255U) && (PANEL_HEIGHT <= 255U), "Board too large for 8-bit coordinates");
+
+typedef struct PANEL_RECT {
+    uint8_t     nLeft;          /* Leftmost column */
+    uint8_t     nTop;           /* Topmost row */
+    uint8_t     nWidth;         /* Width in pixels */
+    uint8_t     nHeight;        /* Height in pixels */
+} panel_rect;
+
+/* The whole board */
+constexpr panel_rect koPanelRect = {0U, 0U, PANEL_WIDTH, PANEL_HEIGHT};
+
+/*
+ * Tiles are chained row by row, left to right, so the driver sees one PANEL_TILE_COUNT-wide strip
+ * of PANEL_TILE_HEIGHT rows. These map a board pixel onto that strip.
+ */
+constexpr int16_t panelChainX(const int16_t x, const int16_t y)
+{
+    return (int16_t)((y / (int16_t)PANEL_TILE_HEIGHT) * (int16_t)PANEL_WIDTH + x);
+}
+
+constexpr int16_t panelChainY(const int16_t y)
+{
+    return (int16_t)(y % (int16_t)PANEL_TILE_HEIGHT);
+}
+
+static_assert((panelChainX(5, 5) == 5) && (panelChainY(5) == 5), "First tile maps onto itself");
+static_assert((PANEL_CHAIN_ROWS < 2U) || (panelChainX(3, PANEL_TILE_HEIGHT) == (int16_t)(PANEL_WIDTH + 3U)),
+              "Second tile row follows the first along the chain");
+
+#endif //LED_BULLETIN_BOARD_PANEL_GEOMETRY_H
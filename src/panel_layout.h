@@ -0,0 +1,84 @@
+//
+// Declarative panel layout: every widget's rectangle, checked at compile time.
+//
+
+#ifndef LED_BULLETIN_BOARD_PANEL_LAYOUT_H
+#define LED_BULLETIN_BOARD_PANEL_LAYOUT_H
+
+#include <stdint.h>
+#include "panel_geometry.h"
+
+/* Width of each character */
+#define TEXT_WIDTH      6U
+/* Height of each character */
+#define TEXT_HEIGHT     8U
+/* Pixels inked by a run of characters (the last character's spacing column stays blank) */
+#define TEXT_SPAN(n)    ((n) * TEXT_WIDTH - 1U)
+
+/* Panel regions, each widget only ever draws inside its own */
+enum LayoutRegions {
+    REGION_DAY,
+    REGION_DATE_SEPARATOR,
+    REGION_MONTH,
+    REGION_HOUR,
+    REGION_TIME_SEPARATOR,
+    REGION_MINUTE,
+    REGION_TODO_LINE_1,
+    REGION_TODO_LINE_2,
+    REGION_GRAPHIC,
+    REGION_CAROUSEL,
+    REGION_COUNT
+};
+
+typedef struct LAYOUT_REGION {
+    int16_t     nLeft;          /* Leftmost column */
+    int16_t     nTop;           /* Topmost row */
+    uint8_t     nWidth;         /* Width in pixels */
+    uint8_t     nHeight;        /* Height in pixels */
+    int8_t      nCursorOffset;  /* Text cursor relative to nLeft, for glyphs inked away from their cell's edge */
+} layout_region;
+
+/* Date on the left, time on the right, TODO beside the graphic & the carousel along the bottom */
+constexpr layout_region kaoLayout[REGION_COUNT] = {
+    /* REGION_DAY            */ {0,                                      0,                          TEXT_SPAN(2U), TEXT_HEIGHT,      0},
+    /* REGION_DATE_SEPARATOR */ {2 * TEXT_WIDTH,                         0,                          1U,            TEXT_HEIGHT,      0},
+    /* REGION_MONTH          */ {3 * TEXT_WIDTH - 4,                     0,                          TEXT_SPAN(2U), TEXT_HEIGHT,      0},
+    /* REGION_HOUR           */ {PANEL_WIDTH - 5 * TEXT_WIDTH + 4,       0,                          TEXT_SPAN(2U), TEXT_HEIGHT,      0},
+    /* REGION_TIME_SEPARATOR */ {PANEL_WIDTH - 3 * TEXT_WIDTH + 3,       0,                          2U,            TEXT_HEIGHT,      -1},
+    /* REGION_MINUTE         */ {PANEL_WIDTH - 2 * TEXT_WIDTH,           0,                          TEXT_SPAN(2U), TEXT_HEIGHT,      0},
+    /* REGION_TODO_LINE_1    */ {17,                                     TEXT_HEIGHT,                PANEL_WIDTH - 17U, TEXT_HEIGHT,  0},
+    /* REGION_TODO_LINE_2    */ {17,                                     2 * TEXT_HEIGHT,            PANEL_WIDTH - 17U, TEXT_HEIGHT,  0},
+    /* REGION_GRAPHIC        */ {0,                                      TEXT_HEIGHT + 1,            17U,           2U * TEXT_HEIGHT - 1U, 0},
+    /* REGION_CAROUSEL       */ {0,                                      PANEL_HEIGHT - TEXT_HEIGHT, PANEL_WIDTH,   TEXT_HEIGHT,      0},
+};
+
+/*=== C H E C K S ===*/
+
+constexpr bool layoutFits(const layout_region &koRegion)
+{
+    return (koRegion.nLeft >= 0) && (koRegion.nTop >= 0) && (koRegion.nWidth > 0U) && (koRegion.nHeight > 0U)
+        && ((koRegion.nLeft + koRegion.nWidth) <= (int16_t)PANEL_WIDTH)
+        && ((koRegion.nTop + koRegion.nHeight) <= (int16_t)PANEL_HEIGHT);
+}
+
+constexpr bool layoutOverlap(const layout_region &koA, const layout_region &koB)
+{
+    return (koA.nLeft < (koB.nLeft + koB.nWidth)) && (koB.nLeft < (koA.nLeft + koA.nWidth))
+        && (koA.nTop < (koB.nTop + koB.nHeight)) && (koB.nTop < (koA.nTop + koA.nHeight));
+}
+
+constexpr bool layoutClearOf(uint8_t nRegion, uint8_t nOther)
+{
+    return (nOther >= REGION_COUNT) ? true
+        : (!layoutOverlap(kaoLayout[nRegion], kaoLayout[nOther]) && layoutClearOf(nRegion, nOther + 1U));
+}
+
+constexpr bool layoutValid(uint8_t nRegion)
+{
+    return (nRegion >= REGION_COUNT) ? true
+        : (layoutFits(kaoLayout[nRegion]) && layoutClearOf(nRegion, nRegion + 1U) && layoutValid(nRegion + 1U));
+}
+
+static_assert(layoutValid(0U), "Layout regions must fit on the panel without overlapping");
+
+#endif //LED_BULLETIN_BOARD_PANEL_LAYOUT_H
@@ -0,0 +1,255 @@
+#include "shadow_panel.h"
+
+/**
+ * Begins the panel, learns the driver's colour layout so drawn colours can be read back as 4-bit channels
+ * & builds every brightness level's driver colours, starting at full brightness
+ */
+void ShadowMatrixPanel::begin()
+{
+    P3RGB64x32MatrixPanel::begin();
+    nRedShift   = __builtin_ctz(color444(1U, 0U, 0U));
+    nGreenShift = __builtin_ctz(color444(0U, 1U, 0U));
+    nBlueShift  = __builtin_ctz(color444(0U, 0U, 1U));
+    for (uint8_t nLevel = 0U; nLevel < BRIGHTNESS_LEVELS; nLevel++)
+    {
+        for (uint8_t nStep = 0U; nStep < PALETTE_CHANNEL_STEPS; nStep++)
+        {
+            const uint8_t knValue = kanBrightnessTable[nLevel][nStep];
+            anPalette[nLevel][0][nStep] = color555(knValue, 0U, 0U);
+            anPalette[nLevel][1][nStep] = color555(0U, knValue, 0U);
+            anPalette[nLevel][2][nStep] = color555(0U, 0U, knValue);
+        }
+    }
+    nBrightness = BRIGHTNESS_100;
+    kpanPalette = anPalette[nBrightness];
+    /* Black is black at every level */
+    nLastColour = 0U;
+    nLast444    = 0U;
+    nLastDriver = 0U;
+    nSequence   = 0U;
+    bFilling    = false;
+    memset(anShadow, 0, sizeof(anShadow));
+    memset(anSent, 0, sizeof(anSent));
+    memset(abDirtyRows, 0, sizeof(abDirtyRows));
+    clearClipRect();
+}
+
+/**
+ * Draws a pixel inside the clip rectangle at the current brightness & records it in the shadow as drawn
+ * @param x Column
+ * @param y Row
+ * @param c Colour (color444)
+ */
+void ShadowMatrixPanel::drawPixel(int16_t x, int16_t y, uint16_t c)
+{
+    if (!bFilling && ((x < nClipLeft) || (y < nClipTop) || (x >= nClipRight) || (y >= nClipBottom))) {
+        return;
+    }
+    /* fillScreen() hands the driver a colour that's already at the current brightness */
+    if (bFilling) {
+        P3RGB64x32MatrixPanel::drawPixel(panelChainX(x, y), panelChainY(y), c);
+        return;
+    }
+    if (c != nLastColour) {
+        nLastColour = c;
+        nLast444    = to444(c);
+        nLastDriver = toDriver(nLast444);
+    }
+    P3RGB64x32MatrixPanel::drawPixel(panelChainX(x, y), panelChainY(y), nLastDriver);
+    if ((x < 0) || (y < 0) || (x >= (int16_t)PANEL_WIDTH) || (y >= (int16_t)PANEL_HEIGHT)) {
+        return;
+    }
+    anShadow[y][x] = nLast444;
+    abDirtyRows[y] = true;
+}
+
+/**
+ * Fills the screen & the shadow in one go
+ * @param c Colour (color444)
+ */
+void ShadowMatrixPanel::fillScreen(uint16_t c)
+{
+    const uint16_t kn444 = to444(c);
+    for (uint8_t y = 0U; y < PANEL_HEIGHT; y++)
+    {
+        for (uint8_t x = 0U; x < PANEL_WIDTH; x++)
+        {
+            anShadow[y][x] = kn444;
+        }
+        abDirtyRows[y] = true;
+    }
+    /* The driver may fill through drawPixel(), which mustn't record every pixel again */
+    bFilling = true;
+    P3RGB64x32MatrixPanel::fillScreen(toDriver(kn444));
+    bFilling = false;
+}
+
+void ShadowMatrixPanel::setClipRect(const int16_t knLeft, const int16_t knTop, const uint8_t knWidth, const uint8_t knHeight)
+{
+    nClipLeft   = knLeft;
+    nClipTop    = knTop;
+    nClipRight  = knLeft + knWidth;
+    nClipBottom = knTop + knHeight;
+}
+
+void ShadowMatrixPanel::clearClipRect()
+{
+    setClipRect(0, 0, PANEL_WIDTH, PANEL_HEIGHT);
+}
+
+void ShadowMatrixPanel::setBrightness(const uint8_t knLevel)
+{
+    if ((knLevel >= BRIGHTNESS_LEVELS) || (knLevel == nBrightness)) {
+        return;
+    }
+    nBrightness = knLevel;
+    kpanPalette = anPalette[nBrightness];
+    nLastDriver = toDriver(nLast444);
+
+    /* The shadow holds colours as drawn, so nothing above needs to draw again & the mirror sees no change */
+    uint16_t nRun444 = 0U, nRunDriver = 0U;
+    for (uint8_t y = 0U; y < PANEL_HEIGHT; y++)
+    {
+        for (uint8_t x = 0U; x < PANEL_WIDTH; x++)
+        {
+            /* Black stays black, & neighbours mostly share a colour */
+            const uint16_t kn444 = anShadow[y][x];
+            if (kn444 == 0U) {
+                continue;
+            }
+            if (kn444 != nRun444) {
+                nRun444    = kn444;
+                nRunDriver = toDriver(kn444);
+            }
+            P3RGB64x32MatrixPanel::drawPixel(panelChainX(x, y), panelChainY(y), nRunDriver);
+        }
+    }
+}
+
+uint16_t ShadowMatrixPanel::drawFrame444(const uint16_t kpanFrame[PANEL_HEIGHT][PANEL_WIDTH], const panel_rect &koWindow)
+{
+    uint16_t nDrawn = 0U;
+    for (uint8_t y = koWindow.nTop; y < (koWindow.nTop + koWindow.nHeight); y++)
+    {
+        for (uint8_t x = koWindow.nLeft; x < (koWindow.nLeft + koWindow.nWidth); x++)
+        {
+            if (kpanFrame[y][x] != anShadow[y][x]) {
+                drawPixel(x, y, from444(kpanFrame[y][x]));
+                nDrawn++;
+            }
+        }
+    }
+    return nDrawn;
+}
+
+uint16_t ShadowMatrixPanel::encodeMirrorFrame(uint8_t *pnFrame, const bool bKeyframe)
+{
+    uint8_t *pnOut = pnFrame + MIRROR_HEADER_SIZE;
+    uint16_t nSpans = 0U;
+
+    for (uint8_t y = 0U; y < PANEL_HEIGHT; y++)
+    {
+        if (!bKeyframe && !abDirtyRows[y]) {
+            continue;
+        }
+        abDirtyRows[y] = false;
+
+        if (bKeyframe) {
+            pnOut = packSpan(pnOut, y, 0U, PANEL_WIDTH);
+            nSpans++;
+            continue;
+        }
+
+        /* Changed spans only, bridging short unchanged gaps */
+        uint8_t x = 0U;
+        while (x < PANEL_WIDTH)
+        {
+            while ((x < PANEL_WIDTH) && (anShadow[y][x] == anSent[y][x])) {
+                x++;
+            }
+            if (x >= PANEL_WIDTH) {
+                break;
+            }
+            const uint8_t knStart = x;
+            uint8_t nEnd = x + 1U;
+            for (x = nEnd; (x < PANEL_WIDTH) && ((uint8_t)(x - nEnd) < MIRROR_SPAN_GAP); x++)
+            {
+                if (anShadow[y][x] != anSent[y][x]) {
+                    nEnd = x + 1U;
+                }
+            }
+            pnOut = packSpan(pnOut, y, knStart, nEnd - knStart);
+            nSpans++;
+            x = nEnd;
+        }
+    }
+
+    if (nSpans == 0U) {
+        return 0U;
+    }
+
+    pnFrame[0] = MIRROR_MAGIC_0;
+    pnFrame[1] = MIRROR_MAGIC_1;
+    pnFrame[2] = bKeyframe ? MIRROR_FLAG_KEYFRAME : 0U;
+    pnFrame[3] = nSequence++;
+    pnFrame[4] = PANEL_WIDTH;
+    pnFrame[5] = PANEL_HEIGHT;
+    pnFrame[6] = nSpans & 0xFFU;
+    pnFrame[7] = nSpans >> 8U;
+
+    /* 8-bit sum of everything after the magic */
+    uint8_t nChecksum = 0U;
+    for (uint8_t *pnByte = pnFrame + 2U; pnByte < pnOut; pnByte++)
+    {
+        nChecksum += *pnByte;
+    }
+    *pnOut++ = nChecksum;
+    return (uint16_t)(pnOut - pnFrame);
+}
+
+/**
+ * Reads a driver colour back as 0x0RGB
+ */
+uint16_t ShadowMatrixPanel::to444(const uint16_t knColour) const
+{
+    return (((knColour >> nRedShift) & 0xFU) << 8U) | (((knColour >> nGreenShift) & 0xFU) << 4U) | ((knColour >> nBlueShift) & 0xFU);
+}
+
+/**
+ * Turns 0x0RGB back into a driver colour
+ */
+uint16_t ShadowMatrixPanel::from444(const uint16_t kn444) const
+{
+    return color444((kn444 >> 8U) & 0xFU, (kn444 >> 4U) & 0xFU, kn444 & 0xFU);
+}
+
+/**
+ * Turns 0x0RGB into a driver colour (color555) at the current brightness
+ */
+uint16_t ShadowMatrixPanel::toDriver(const uint16_t kn444) const
+{
+    return kpanPalette[0][(kn444 >> 8U) & 0xFU] | kpanPalette[1][(kn444 >> 4U) & 0xFU] | kpanPalette[2][kn444 & 0xFU];
+}
+
+/**
+ * Writes one span of the shadow into a mirror frame & marks it as sent
+ * @return Position after the span
+ */
+uint8_t *ShadowMatrixPanel::packSpan(uint8_t *pnOut, const uint8_t knRow, const uint8_t knCol, const uint8_t knLength)
+{
+    *pnOut++ = knRow;
+    *pnOut++ = knCol;
+    *pnOut++ = knLength;
+    for (uint8_t i = 0U; i < knLength; i += 2U)
+    {
+        const uint16_t knFirst  = anShadow[knRow][knCol + i];
+        const uint16_t knSecond = ((i + 1U) < knLength) ? anShadow[knRow][knCol + i + 1U] : 0U;
+        *pnOut++ = knFirst >> 4U;
+        *pnOut++ = ((knFirst & 0xFU) << 4U) | (knSecond >> 8U);
+        if ((i + 1U) < knLength) {
+            *pnOut++ = knSecond & 0xFFU;
+        }
+    }
+    memcpy(&anSent[knRow][knCol], &anShadow[knRow][knCol], knLength * sizeof(uint16_t));
+    return pnOut;
+}
@@ -0,0 +1,105 @@
+//
+// Matrix panel that keeps a 4-bit-per-channel shadow of what it shows, so the contents can be mirrored over serial
+// & redrawn at another brightness. The driver gets 5-bit channels, so dimmed colours keep their gamma steps.
+//
+
+#ifndef LED_BULLETIN_BOARD_SHADOW_PANEL_H
+#define LED_BULLETIN_BOARD_SHADOW_PANEL_H
+
+#include <Arduino.h>
+#include <P3RGB64x32MatrixPanel.h>
+#include "panel_geometry.h"
+#include "colour_palette.h"
+
+/* Mirror frame: magic 'P' 'M', flags, sequence, width, height, span count (LE16), spans, checksum */
+#define MIRROR_MAGIC_0          0x50U
+#define MIRROR_MAGIC_1          0x4DU
+#define MIRROR_HEADER_SIZE      8U
+/* Each span: row, first column, pixel count, then pixels packed two per three bytes (0xRG 0xBR 0xGB) */
+#define MIRROR_SPAN_HEADER_SIZE 3U
+/* Flag set on frames carrying the whole panel, so a decoder can join mid-session */
+#define MIRROR_FLAG_KEYFRAME    0x01U
+/* Unchanged pixels a span bridges before a new span (and its header) becomes cheaper */
+#define MIRROR_SPAN_GAP         2U
+/* Most spans a row splits into: lone changed pixels, each MIRROR_SPAN_GAP unchanged pixels from the next */
+#define MIRROR_ROW_MAX_SPANS    ((PANEL_WIDTH + MIRROR_SPAN_GAP) / (MIRROR_SPAN_GAP + 1U))
+/*
+ * Most bytes a row encodes to. Each span costs its header plus 1.5 bytes a pixel (rounded up), and the gaps between
+ * spans hold no pixels, so a row is largest split into as many single-pixel spans as it can hold
+ * (every third column on 64 pixels: 22 spans of 5 bytes, against 99 bytes for one full-width span).
+ */
+#define MIRROR_ROW_MAX_SIZE     ((MIRROR_ROW_MAX_SPANS * (2U * MIRROR_SPAN_HEADER_SIZE + 1U) \
+                                  + 3U * (PANEL_WIDTH - MIRROR_SPAN_GAP * (MIRROR_ROW_MAX_SPANS - 1U)) + 1U) / 2U)
+/* Worst case: every row at its most fragmented */
+#define MIRROR_MAX_FRAME_SIZE   (MIRROR_HEADER_SIZE + PANEL_HEIGHT * MIRROR_ROW_MAX_SIZE + 1U)
+static_assert(MIRROR_ROW_MAX_SIZE >= (MIRROR_SPAN_HEADER_SIZE + (PANEL_WIDTH * 3U + 1U) / 2U), "Keyframe rows must fit too");
+static_assert(MIRROR_MAX_FRAME_SIZE <= UINT16_MAX, "Mirror frame sizes are 16-bit");
+
+class ShadowMatrixPanel : public P3RGB64x32MatrixPanel {
+public:
+    using P3RGB64x32MatrixPanel::P3RGB64x32MatrixPanel;
+
+    void begin();
+    void drawPixel(int16_t x, int16_t y, uint16_t c) override;
+    void fillScreen(uint16_t c) override;
+
+    /**
+     * Restricts drawing to a rectangle until cleared (fillScreen() still covers the whole panel)
+     */
+    void setClipRect(const int16_t knLeft, const int16_t knTop, const uint8_t knWidth, const uint8_t knHeight);
+    void clearClipRect();
+
+    /**
+     * Shows everything through another brightness table (call with exclusive matrix access). The driver has no global
+     * dimming, every pixel holds its own channels, so the lit pixels are redrawn from the shadow; the shadow & the
+     * mirror see no change.
+     * @param knLevel BrightnessLevels
+     */
+    void setBrightness(const uint8_t knLevel);
+    uint8_t brightness() const { return nBrightness; }
+
+    /**
+     * Draws a window of a frame, only touching the driver for pixels that differ from what's shown (call with exclusive matrix access)
+     * @param kpanFrame Frame as 0x0RGB
+     * @param koWindow  Part of the frame to draw, the rest of the panel is left alone
+     * @return          Pixels drawn
+     */
+    uint16_t drawFrame444(const uint16_t kpanFrame[PANEL_HEIGHT][PANEL_WIDTH], const panel_rect &koWindow = koPanelRect);
+
+    /**
+     * Encodes the pixels changed since the last call as one mirror frame (call with exclusive matrix access)
+     * @param pnFrame   Output, at least MIRROR_MAX_FRAME_SIZE bytes
+     * @param bKeyframe Send the whole panel rather than just the changes
+     * @return          Frame size in bytes, 0 if nothing changed
+     */
+    uint16_t encodeMirrorFrame(uint8_t *pnFrame, const bool bKeyframe);
+
+    /**
+     * Turns 0x0RGB (e.g. a COLOUR_ name) into a colour to draw with, shown at the current brightness
+     */
+    uint16_t from444(const uint16_t kn444) const;
+
+private:
+    uint16_t to444(const uint16_t knColour) const;
+    uint16_t toDriver(const uint16_t kn444) const;
+    uint8_t *packSpan(uint8_t *pnOut, const uint8_t knRow, const uint8_t knCol, const uint8_t knLength);
+
+    uint16_t    anShadow[PANEL_HEIGHT][PANEL_WIDTH];    /* Current contents as 0x0RGB */
+    uint16_t    anSent[PANEL_HEIGHT][PANEL_WIDTH];      /* Contents as last mirrored */
+    /* Driver colour bits (color555) for each level, channel (red, green, blue) & channel step */
+    uint16_t    anPalette[BRIGHTNESS_LEVELS][3U][PALETTE_CHANNEL_STEPS];
+    /* Active level's channels in anPalette */
+    const uint16_t (*kpanPalette)[PALETTE_CHANNEL_STEPS];
+    uint8_t     nBrightness;                            /* Active BrightnessLevels */
+    uint16_t    nLastColour;                            /* Colour drawPixel() last converted, text draws runs of one */
+    uint16_t    nLast444;                               /* It as 0x0RGB */
+    uint16_t    nLastDriver;                            /* It at the current brightness */
+    bool        abDirtyRows[PANEL_HEIGHT];              /* Rows drawn to since the last mirror frame */
+    uint8_t     nRedShift, nGreenShift, nBlueShift;     /* Where color444() puts each 4-bit channel */
+    uint8_t     nSequence;                              /* Mirror frame counter, lets a decoder spot drops */
+    bool        bFilling;                               /* Inside fillScreen(), shadow already updated */
+    int16_t     nClipLeft, nClipTop;                    /* Drawable rectangle, inclusive */
+    int16_t     nClipRight, nClipBottom;                /* Drawable rectangle, exclusive */
+};
+
+#endif //LED_BULLETIN_BOARD_SHADOW_PANEL_H
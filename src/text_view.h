@@ -0,0 +1,76 @@
+//
+// Non-owning text views & fixed-capacity inline strings for the render path, so drawing never touches the heap.
+//
+
+#ifndef LED_BULLETIN_BOARD_TEXT_VIEW_H
+#define LED_BULLETIN_BOARD_TEXT_VIEW_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Borrowed, not necessarily NUL-terminated, run of characters */
+typedef struct TEXT_VIEW {
+    const char *kpcData;    /* First character (not owned) */
+    uint16_t    nLength;    /* Number of characters */
+} text_view;
+
+/**
+ * View over a string literal or flash-resident array, length known at compile time
+ */
+template <size_t N>
+constexpr text_view textView(const char (&kacText)[N])
+{
+    return {kacText, (uint16_t)(N - 1U)};
+}
+
+/**
+ * View over a NUL-terminated string (e.g. one held by the JSON document), empty if null
+ */
+inline text_view textViewOf(const char *kpcText)
+{
+    return {(kpcText != nullptr) ? kpcText : "", (uint16_t)((kpcText != nullptr) ? strlen(kpcText) : 0U)};
+}
+
+/* String stored inline with a fixed capacity */
+template <uint16_t N>
+struct inline_string {
+    char        acData[N + 1U];     /* Characters, always NUL-terminated */
+    uint16_t    nLength;            /* Number of characters used */
+
+    text_view view() const
+    {
+        return {acData, nLength};
+    }
+};
+
+/**
+ * Formats a number as two digits, adding a leading zero to single digits
+ * @param knValue Number (0-99)
+ * @return        Padded digits
+ */
+inline inline_string<2U> padTwoDigits(const uint8_t knValue)
+{
+    inline_string<2U> oDigits;
+    oDigits.acData[0] = (char)('0' + ((knValue / 10U) % 10U));
+    oDigits.acData[1] = (char)('0' + (knValue % 10U));
+    oDigits.acData[2] = '\0';
+    oDigits.nLength   = 2U;
+    return oDigits;
+}
+
+/**
+ * Longest text a printf format can produce when every conversion is %u (10 digits at most)
+ * @param kpcFormat Format string
+ * @return          Characters, not counting the NUL
+ */
+constexpr size_t formattedLengthMax(const char *kpcFormat)
+{
+    return (*kpcFormat == '\0') ? 0U
+        : ((kpcFormat[0] == '%') && (kpcFormat[1] == 'u')) ? (10U + formattedLengthMax(kpcFormat + 2))
+        : (1U + formattedLengthMax(kpcFormat + 1));
+}
+
+static_assert(formattedLengthMax("%u px\n") == 14U, "Worst case %u is 4294967295");
+
+#endif //LED_BULLETIN_BOARD_TEXT_VIEW_H
@@ -0,0 +1,253 @@
+//
+// Compile-time time zone rules & UTC epoch to local time conversion.
+//
+
+#ifndef LED_BULLETIN_BOARD_TIME_ZONE_RULES_H
+#define LED_BULLETIN_BOARD_TIME_ZONE_RULES_H
+
+#include <stdint.h>
+
+/* Seconds in a day */
+#define TZ_SECONDS_PER_DAY  86400
+/* Week number meaning "the last one in the month" */
+#define TZ_LAST_WEEK        5U
+
+/* Days of the week, as counted by the conversions below */
+enum TzDaysOfWeek {
+    TZ_SUNDAY,
+    TZ_MONDAY,
+    TZ_TUESDAY,
+    TZ_WEDNESDAY,
+    TZ_THURSDAY,
+    TZ_FRIDAY,
+    TZ_SATURDAY
+};
+
+/* A DST change, given as the nth weekday of a month at a time of day in UTC */
+typedef struct TZ_TRANSITION {
+    uint8_t     nMonth;         /* Month of the change (1-12) */
+    uint8_t     nWeek;          /* Which occurrence of the weekday (1-4, or TZ_LAST_WEEK) */
+    uint8_t     nDayOfWeek;     /* Weekday of the change (TzDaysOfWeek) */
+    int32_t     nUTCSeconds;    /* Seconds into that day (UTC) at which the change happens */
+} tz_transition;
+
+/* A time zone's offsets & the yearly rule switching between them */
+typedef struct TZ_RULE {
+    int32_t         nStdOffset; /* Seconds east of UTC outside DST */
+    int32_t         nDstOffset; /* Seconds east of UTC during DST (equal to nStdOffset if there is no DST) */
+    tz_transition   oDstStart;  /* When DST begins each year */
+    tz_transition   oDstEnd;    /* When DST ends each year */
+} tz_rule;
+
+/* Broken-down local time */
+typedef struct LOCAL_TIME {
+    int16_t     nYear;
+    uint8_t     nMonth;         /* 1-12 */
+    uint8_t     nDay;           /* 1-31 */
+    uint8_t     nHour;
+    uint8_t     nMinute;
+    uint8_t     nSecond;
+    uint8_t     nDayOfWeek;     /* TzDaysOfWeek */
+    bool        bDst;           /* Whether DST is in effect */
+} local_time;
+
+/*=== R U L E S ===*/
+
+/* EU: last Sunday of March to last Sunday of October, both at 01:00 UTC */
+#define TZ_EU_DST_START {3U,  TZ_LAST_WEEK, TZ_SUNDAY, 3600}
+#define TZ_EU_DST_END   {10U, TZ_LAST_WEEK, TZ_SUNDAY, 3600}
+
+constexpr tz_rule koTzUTC           = {0,    0,    TZ_EU_DST_START, TZ_EU_DST_END};
+constexpr tz_rule koTzEuropeDublin  = {0,    3600, TZ_EU_DST_START, TZ_EU_DST_END};
+constexpr tz_rule koTzEuropeLondon  = {0,    3600, TZ_EU_DST_START, TZ_EU_DST_END};
+constexpr tz_rule koTzEuropeBerlin  = {3600, 7200, TZ_EU_DST_START, TZ_EU_DST_END};
+
+/*=== C I V I L   C A L E N D A R ===*/
+/* Single-expression constexpr so the rules can be evaluated at compile time (C++11). Valid from 1970 onwards. */
+
+/**
+ * Days since 1970-01-01 of a date (proleptic Gregorian, years from March so leap days fall last)
+ */
+constexpr int32_t tzDaysFromMarchYear(int32_t nYear, uint32_t nMonth, uint32_t nDay)
+{
+    return (nYear / 400) * 146097
+         + (nYear % 400) * 365 + (nYear % 400) / 4 - (nYear % 400) / 100
+         + (int32_t)((153U * ((nMonth > 2U) ? (nMonth - 3U) : (nMonth + 9U)) + 2U) / 5U + nDay - 1U)
+         - 719468;
+}
+
+constexpr int32_t tzDaysFromCivil(int32_t nYear, uint32_t nMonth, uint32_t nDay)
+{
+    return tzDaysFromMarchYear(nYear - ((nMonth <= 2U) ? 1 : 0), nMonth, nDay);
+}
+
+constexpr bool tzIsLeapYear(int32_t nYear)
+{
+    return ((nYear % 4) == 0) && (((nYear % 100) != 0) || ((nYear % 400) == 0));
+}
+
+constexpr uint8_t tzDaysInMonth(int32_t nYear, uint32_t nMonth)
+{
+    return (nMonth == 2U) ? (tzIsLeapYear(nYear) ? 29U : 28U)
+         : ((nMonth == 4U) || (nMonth == 6U) || (nMonth == 9U) || (nMonth == 11U)) ? 30U : 31U;
+}
+
+constexpr uint8_t tzDayOfWeek(int32_t nDays)
+{
+    /* 1970-01-01 was a Thursday */
+    return (uint8_t)((nDays + TZ_THURSDAY) % 7);
+}
+
+/* Day of the 400-year era, year of the era & day of the March-based year */
+constexpr int32_t tzDayOfEra(int32_t nDays)  { return (nDays + 719468) % 146097; }
+constexpr int32_t tzYearOfEra(int32_t nDoE)  { return (nDoE - nDoE / 1460 + nDoE / 36524 - nDoE / 146096) / 365; }
+constexpr int32_t tzDayOfYear(int32_t nDoE)
+{
+    return nDoE - (365 * tzYearOfEra(nDoE) + tzYearOfEra(nDoE) / 4 - tzYearOfEra(nDoE) / 100);
+}
+constexpr int32_t tzMarchMonth(int32_t nDays) { return (5 * tzDayOfYear(tzDayOfEra(nDays)) + 2) / 153; }
+
+constexpr uint8_t tzMonthFromDays(int32_t nDays)
+{
+    return (uint8_t)((tzMarchMonth(nDays) < 10) ? (tzMarchMonth(nDays) + 3) : (tzMarchMonth(nDays) - 9));
+}
+
+constexpr uint8_t tzDayFromDays(int32_t nDays)
+{
+    return (uint8_t)(tzDayOfYear(tzDayOfEra(nDays)) - (153 * tzMarchMonth(nDays) + 2) / 5 + 1);
+}
+
+constexpr int32_t tzYearFromDays(int32_t nDays)
+{
+    return ((nDays + 719468) / 146097) * 400 + tzYearOfEra(tzDayOfEra(nDays)) + ((tzMonthFromDays(nDays) <= 2U) ? 1 : 0);
+}
+
+constexpr int32_t tzDaysFromEpoch(int64_t nEpoch)
+{
+    return (int32_t)(nEpoch / TZ_SECONDS_PER_DAY);
+}
+
+/*=== R U L E   E V A L U A T I O N ===*/
+
+/**
+ * Day (since 1970) of the nth/last given weekday of a month
+ */
+constexpr int32_t tzTransitionDay(int32_t nYear, const tz_transition &koTransition)
+{
+    return (koTransition.nWeek == TZ_LAST_WEEK)
+        /* Step back from the last of the month to the weekday */
+        ? tzDaysFromCivil(nYear, koTransition.nMonth, tzDaysInMonth(nYear, koTransition.nMonth))
+          - ((tzDayOfWeek(tzDaysFromCivil(nYear, koTransition.nMonth, tzDaysInMonth(nYear, koTransition.nMonth)))
+              - koTransition.nDayOfWeek + 7) % 7)
+        /* Step forward from the first of the month to the weekday, then on by whole weeks */
+        : tzDaysFromCivil(nYear, koTransition.nMonth, 1U)
+          + ((koTransition.nDayOfWeek - tzDayOfWeek(tzDaysFromCivil(nYear, koTransition.nMonth, 1U)) + 7) % 7)
+          + 7 * (koTransition.nWeek - 1);
+}
+
+/**
+ * UTC epoch of a transition in a given year
+ */
+constexpr int64_t tzTransitionEpoch(int32_t nYear, const tz_transition &koTransition)
+{
+    return (int64_t)tzTransitionDay(nYear, koTransition) * TZ_SECONDS_PER_DAY + koTransition.nUTCSeconds;
+}
+
+constexpr bool tzIsDstInYear(int64_t nUTC, const tz_rule &koRule, int32_t nYear)
+{
+    return (koRule.nDstOffset == koRule.nStdOffset) ? false
+        /* Northern hemisphere, DST mid-year */
+        : (tzTransitionEpoch(nYear, koRule.oDstStart) < tzTransitionEpoch(nYear, koRule.oDstEnd))
+        ? ((nUTC >= tzTransitionEpoch(nYear, koRule.oDstStart)) && (nUTC < tzTransitionEpoch(nYear, koRule.oDstEnd)))
+        /* Southern hemisphere, DST spans the new year */
+        : ((nUTC >= tzTransitionEpoch(nYear, koRule.oDstStart)) || (nUTC < tzTransitionEpoch(nYear, koRule.oDstEnd)));
+}
+
+/**
+ * Whether DST is in effect at a UTC epoch
+ */
+constexpr bool tzIsDst(int64_t nUTC, const tz_rule &koRule)
+{
+    return tzIsDstInYear(nUTC, koRule, tzYearFromDays(tzDaysFromEpoch(nUTC)));
+}
+
+/**
+ * Seconds east of UTC at a UTC epoch
+ */
+constexpr int32_t tzOffset(int64_t nUTC, const tz_rule &koRule)
+{
+    return tzIsDst(nUTC, koRule) ? koRule.nDstOffset : koRule.nStdOffset;
+}
+
+/**
+ * UTC epoch shifted into local wall-clock seconds
+ */
+constexpr int64_t tzLocalEpoch(int64_t nUTC, const tz_rule &koRule)
+{
+    return nUTC + tzOffset(nUTC, koRule);
+}
+
+/**
+ * UTC epoch of a local wall-clock time. Times skipped when DST starts resolve an hour early.
+ */
+constexpr int64_t tzUTCFromLocal(int64_t nLocal, const tz_rule &koRule)
+{
+    return nLocal - tzOffset(nLocal - koRule.nStdOffset, koRule);
+}
+
+constexpr local_time tzMakeLocalTime(int64_t nLocal, bool bDst)
+{
+    return {
+        (int16_t)tzYearFromDays(tzDaysFromEpoch(nLocal)),
+        tzMonthFromDays(tzDaysFromEpoch(nLocal)),
+        tzDayFromDays(tzDaysFromEpoch(nLocal)),
+        (uint8_t)((nLocal % TZ_SECONDS_PER_DAY) / 3600),
+        (uint8_t)((nLocal % 3600) / 60),
+        (uint8_t)(nLocal % 60),
+        tzDayOfWeek(tzDaysFromEpoch(nLocal)),
+        bDst
+    };
+}
+
+/**
+ * Converts a UTC epoch to broken-down local time
+ */
+constexpr local_time tzToLocalTime(int64_t nUTC, const tz_rule &koRule)
+{
+    return tzMakeLocalTime(tzLocalEpoch(nUTC, koRule), tzIsDst(nUTC, koRule));
+}
+
+constexpr int64_t tzLocalMidnight(int64_t nUTC, const tz_rule &koRule)
+{
+    return (tzLocalEpoch(nUTC, koRule) / TZ_SECONDS_PER_DAY) * TZ_SECONDS_PER_DAY;
+}
+
+constexpr int64_t tzNextFromCandidate(int64_t nUTC, const tz_rule &koRule, int32_t nSecondOfDay, int64_t nCandidate)
+{
+    return (nCandidate > nUTC) ? nCandidate
+        : tzUTCFromLocal(tzLocalMidnight(nUTC, koRule) + TZ_SECONDS_PER_DAY + nSecondOfDay, koRule);
+}
+
+/**
+ * UTC epoch of the next time the local clock reads a given time of day, correct across DST changes
+ * @param nUTC         Now (UTC epoch)
+ * @param koRule       Time zone
+ * @param nSecondOfDay Local time of day, in seconds since midnight
+ */
+constexpr int64_t tzNextLocalTime(int64_t nUTC, const tz_rule &koRule, int32_t nSecondOfDay)
+{
+    return tzNextFromCandidate(nUTC, koRule, nSecondOfDay,
+                               tzUTCFromLocal(tzLocalMidnight(nUTC, koRule) + nSecondOfDay, koRule));
+}
+
+/*=== C H E C K S ===*/
+
+static_assert(tzDaysFromCivil(1970, 1U, 1U) == 0, "Epoch day");
+static_assert(tzDayOfWeek(tzDaysFromCivil(2022, 10U, 18U)) == TZ_TUESDAY, "Weekday");
+static_assert(tzTransitionEpoch(2022, koTzEuropeDublin.oDstStart) == 1648342800, "2022-03-27 01:00 UTC");
+static_assert(tzTransitionEpoch(2022, koTzEuropeDublin.oDstEnd) == 1667091600, "2022-10-30 01:00 UTC");
+static_assert(tzToLocalTime(1648342799, koTzEuropeDublin).nHour == 0U, "00:59:59 GMT before DST");
+static_assert(tzToLocalTime(1648342800, koTzEuropeDublin).nHour == 2U, "02:00 IST once DST starts");
+static_assert(tzNextLocalTime(1667080800, koTzEuropeDublin, 7 * 3600) == 1667113200, "Wake at 07:00 GMT after DST ends");
+
+#endif //LED_BULLETIN_BOARD_TIME_ZONE_RULES_H
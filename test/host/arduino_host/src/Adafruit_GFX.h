@@ -0,0 +1,45 @@
+//
+// Host stand-in for Adafruit GFX: the drawing calls the sketch makes, everything landing in drawPixel().
+// Text uses a fixed 5x7 block glyph per character, enough to count & place pixels the way the real font does.
+//
+
+#ifndef ARDUINO_HOST_ADAFRUIT_GFX_H
+#define ARDUINO_HOST_ADAFRUIT_GFX_H
+
+#include <Arduino.h>
+
+class Adafruit_GFX : public Print {
+public:
+    Adafruit_GFX(int16_t nWidth, int16_t nHeight);
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t c) = 0;
+    virtual void fillScreen(uint16_t c);
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t c);
+    virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t c);
+    virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t c);
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t c);
+    void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t c);
+    void fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t c);
+    void fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t c);
+
+    void setCursor(int16_t x, int16_t y) { nCursorX = x; nCursorY = y; }
+    void setTextColor(uint16_t c) { nTextColour = c; }
+    void setTextSize(uint8_t nSize) { nTextSize = (nSize > 0U) ? nSize : 1U; }
+    void setTextWrap(bool bWrap) { bTextWrap = bWrap; }
+    size_t write(uint8_t nChar) override;
+    using Print::write;
+
+    int16_t width() const { return nGfxWidth; }
+    int16_t height() const { return nGfxHeight; }
+
+protected:
+    void drawChar(int16_t x, int16_t y, uint8_t nChar, uint16_t c, uint8_t nSize);
+
+    int16_t     nGfxWidth, nGfxHeight;  /* Drawable size */
+    int16_t     nCursorX, nCursorY;     /* Where the next character goes */
+    uint16_t    nTextColour;            /* Text foreground, background is left alone */
+    uint8_t     nTextSize;              /* Text magnification */
+    bool        bTextWrap;              /* Wrap text at the right edge */
+};
+
+#endif //ARDUINO_HOST_ADAFRUIT_GFX_H
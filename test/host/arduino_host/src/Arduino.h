@@ -0,0 +1,110 @@
+//
+// Host stand-in for the ESP32 Arduino core & the FreeRTOS calls the sketch makes, for native tests.
+// Time runs on the host's steady clock, or on a virtual clock the tests advance (see host_control.h).
+//
+
+#ifndef ARDUINO_HOST_ARDUINO_H
+#define ARDUINO_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+
+using std::min;
+using std::max;
+
+/* Flash is just memory here */
+#define PROGMEM
+#define F(kpcText)          (kpcText)
+#define pgm_read_byte(p)    (*(const uint8_t *)(p))
+
+/*=== C O R E ===*/
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long nMillis);
+uint32_t esp_random();
+void esp_sleep_enable_timer_wakeup(uint64_t nMicros);
+void esp_deep_sleep_start();
+void configTime(long nGmtOffset, int nDaylightOffset, const char *kpcServer1, const char *kpcServer2 = nullptr, const char *kpcServer3 = nullptr);
+
+/* Heap string, grown with malloc/realloc like the core's */
+class String {
+public:
+    String(const char *kpcText = "");
+    String(const String &koOther);
+    ~String();
+    String &operator=(const String &koOther);
+    String &operator=(const char *kpcText);
+    bool operator==(const char *kpcText) const;
+    bool concat(const char *kpcText);
+    unsigned int length() const { return nLength; }
+    const char *c_str() const { return (pcBuffer != nullptr) ? pcBuffer : ""; }
+
+private:
+    void copy(const char *kpcText, unsigned int nLength);
+
+    char           *pcBuffer;
+    unsigned int    nLength;
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t nByte) = 0;
+    virtual size_t write(const uint8_t *kpnBuffer, size_t nSize);
+
+    size_t print(const char *kpcText);
+    size_t print(const String &ksText);
+    size_t println(const char *kpcText = "");
+    size_t println(const String &ksText);
+    /* Formats into 64 bytes on the stack, longer output mallocs a buffer, as the ESP32 core does */
+    size_t printf(const char *kpcFormat, ...) __attribute__((format(printf, 2, 3)));
+};
+
+/* Output is captured for the tests rather than sent anywhere */
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long nBaud);
+    size_t write(uint8_t nByte) override;
+    size_t write(const uint8_t *kpnBuffer, size_t nSize) override;
+};
+
+extern HardwareSerial Serial;
+
+/*=== F R E E R T O S ===*/
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef struct HOST_TASK *TaskHandle_t;
+typedef struct HOST_MUTEX *SemaphoreHandle_t;
+
+#define configTICK_RATE_HZ  1000U
+#define portTICK_PERIOD_MS  (1000U / configTICK_RATE_HZ)
+#define portMAX_DELAY       ((TickType_t)0xFFFFFFFFU)
+#define pdMS_TO_TICKS(n)    ((TickType_t)(((uint64_t)(n) * configTICK_RATE_HZ) / 1000U))
+#define pdFALSE             0
+#define pdTRUE              1
+#define pdFAIL              0
+#define pdPASS              1
+
+TickType_t xTaskGetTickCount();
+void vTaskDelay(TickType_t nTicks);
+void vTaskDelayUntil(TickType_t *pnPreviousWake, TickType_t nIncrement);
+/* Tasks are host threads, the core is ignored */
+BaseType_t xTaskCreatePinnedToCore(void (*pfTask)(void *), const char *kpcName, uint32_t nStackDepth, void *pvParameters,
+                                   UBaseType_t nPriority, TaskHandle_t *poCreated, BaseType_t nCore);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+BaseType_t xTaskNotifyGive(TaskHandle_t oTask);
+uint32_t ulTaskNotifyTake(BaseType_t bClearOnExit, TickType_t nTicksToWait);
+SemaphoreHandle_t xSemaphoreCreateMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t oMutex, TickType_t nTicksToWait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t oMutex);
+
+#endif //ARDUINO_HOST_ARDUINO_H
@@ -0,0 +1,8 @@
+//
+// Host stand-in for AsyncTCP: the sketch includes it but calls nothing from it.
+//
+
+#ifndef ARDUINO_HOST_ASYNCTCP_H
+#define ARDUINO_HOST_ASYNCTCP_H
+
+#endif //ARDUINO_HOST_ASYNCTCP_H
@@ -0,0 +1,8 @@
+//
+// Host stand-in for the GFX font the sketch includes but doesn't select.
+//
+
+#ifndef ARDUINO_HOST_FREESANSBOLD9PT7B_H
+#define ARDUINO_HOST_FREESANSBOLD9PT7B_H
+
+#endif //ARDUINO_HOST_FREESANSBOLD9PT7B_H
@@ -0,0 +1,38 @@
+//
+// Host stand-in for the ESP32 HTTPClient: there is no network, every request fails to connect.
+// Tests that need responses hand fetchJSON() their own transport instead.
+//
+
+#ifndef ARDUINO_HOST_HTTPCLIENT_H
+#define ARDUINO_HOST_HTTPCLIENT_H
+
+#include <Arduino.h>
+
+#define HTTP_CODE_OK                    200
+#define HTTPC_ERROR_CONNECTION_REFUSED  (-1)
+#define HTTPC_ERROR_READ_TIMEOUT        (-11)
+
+/* A connection that's already closed */
+class WiFiClient {
+public:
+    int available() { return 0; }
+    uint8_t connected() { return 0U; }
+    int read(uint8_t *pnBuffer, size_t nSize) { (void)pnBuffer; (void)nSize; return -1; }
+};
+
+class HTTPClient {
+public:
+    bool begin(const char *kpcURL) { (void)kpcURL; return true; }
+    void setConnectTimeout(int32_t nMillis) { (void)nMillis; }
+    void setTimeout(uint16_t nMillis) { (void)nMillis; }
+    void useHTTP10(bool bUse) { (void)bUse; }
+    int GET() { return HTTPC_ERROR_CONNECTION_REFUSED; }
+    String getString() { return String(); }
+    WiFiClient *getStreamPtr() { return &oClient; }
+    void end() {}
+
+private:
+    WiFiClient oClient;
+};
+
+#endif //ARDUINO_HOST_HTTPCLIENT_H
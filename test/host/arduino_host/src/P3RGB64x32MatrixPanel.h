@@ -0,0 +1,48 @@
+//
+// Host stand-in for the HUB75 driver: keeps what would be lit in a framebuffer the tests can read back.
+// The buffer is the driver's strip of chained tiles, panel_geometry.h decides how many.
+//
+
+#ifndef ARDUINO_HOST_P3RGB64X32MATRIXPANEL_H
+#define ARDUINO_HOST_P3RGB64X32MATRIXPANEL_H
+
+#include <Adafruit_GFX.h>
+#include "panel_geometry.h"
+
+/* Strip of chained tiles the driver shifts out */
+#define HOST_DRIVER_WIDTH   (PANEL_TILE_WIDTH * PANEL_TILE_COUNT)
+#define HOST_DRIVER_HEIGHT  PANEL_TILE_HEIGHT
+
+class P3RGB64x32MatrixPanel : public Adafruit_GFX {
+public:
+    P3RGB64x32MatrixPanel() : Adafruit_GFX(PANEL_WIDTH, PANEL_HEIGHT), anLit(), nWrites(0U) {}
+
+    void begin() {}
+    void drawPixel(int16_t x, int16_t y, uint16_t c) override;
+    /* Same bit layout as the real driver */
+    static uint16_t color444(uint8_t r, uint8_t g, uint8_t b)
+    {
+        return ((r & 0xFU) << 1U) | ((uint16_t)(g & 0xFU) << 6U) | ((uint16_t)(b & 0xFU) << 11U);
+    }
+    static uint16_t color555(uint8_t r, uint8_t g, uint8_t b)
+    {
+        return (r & 0x1FU) | ((uint16_t)(g & 0x1FU) << 5U) | ((uint16_t)(b & 0x1FU) << 10U);
+    }
+
+    /*=== H O S T ===*/
+
+    /**
+     * @return Driver colour last written at a strip position
+     */
+    uint16_t litPixel(int16_t x, int16_t y) const { return anLit[y][x]; }
+    /**
+     * @return Pixels written to the driver so far
+     */
+    uint32_t driverWrites() const { return nWrites; }
+
+private:
+    uint16_t anLit[HOST_DRIVER_HEIGHT][HOST_DRIVER_WIDTH];  /* What the strip would show */
+    uint32_t nWrites;                                       /* drawPixel() calls that landed */
+};
+
+#endif //ARDUINO_HOST_P3RGB64X32MATRIXPANEL_H
@@ -0,0 +1,45 @@
+//
+// Host stand-in for the polled Ticker library: fires its callback from update() once the interval has passed.
+//
+
+#ifndef ARDUINO_HOST_TICKER_H
+#define ARDUINO_HOST_TICKER_H
+
+#include <Arduino.h>
+
+enum resolution_t { MICROS, MILLIS, MICROS_MICROS };
+
+class Ticker {
+public:
+    Ticker(void (*pfCallback)(), uint32_t nInterval, uint32_t nRepeats = 0U, resolution_t eResolution = MICROS)
+        : pfCallback(pfCallback), nInterval(nInterval), nRepeats(nRepeats), nFired(0U), eResolution(eResolution),
+          nLast(0U), bRunning(false) {}
+
+    void start() { nLast = now(); nFired = 0U; bRunning = true; }
+    void stop() { bRunning = false; }
+    void interval(uint32_t nNewInterval) { nInterval = nNewInterval; }
+    void update()
+    {
+        if (!bRunning || ((now() - nLast) < nInterval)) {
+            return;
+        }
+        nLast = now();
+        pfCallback();
+        if ((nRepeats > 0U) && (++nFired >= nRepeats)) {
+            bRunning = false;
+        }
+    }
+
+private:
+    uint32_t now() const { return (eResolution == MILLIS) ? (uint32_t)millis() : (uint32_t)micros(); }
+
+    void        (*pfCallback)();    /* Fired every interval */
+    uint32_t    nInterval;          /* In eResolution units */
+    uint32_t    nRepeats;           /* Times to fire, 0 for forever */
+    uint32_t    nFired;             /* Times fired since start() */
+    resolution_t eResolution;       /* Unit of nInterval */
+    uint32_t    nLast;              /* When it last fired */
+    bool        bRunning;           /* Between start() & stop() */
+};
+
+#endif //ARDUINO_HOST_TICKER_H
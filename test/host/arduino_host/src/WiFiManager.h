@@ -0,0 +1,13 @@
+//
+// Host stand-in for WiFiManager: never connects.
+//
+
+#ifndef ARDUINO_HOST_WIFIMANAGER_H
+#define ARDUINO_HOST_WIFIMANAGER_H
+
+class WiFiManager {
+public:
+    bool autoConnect() { return false; }
+};
+
+#endif //ARDUINO_HOST_WIFIMANAGER_H
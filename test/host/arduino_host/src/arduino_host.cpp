@@ -0,0 +1,621 @@
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include <P3RGB64x32MatrixPanel.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+#include "host_control.h"
+
+/* Serial output kept for hostSerialOutput() */
+#define HOST_SERIAL_CAPTURE     4096U
+/* Buffer ESP32's Print::printf() formats into before it has to malloc */
+#define HOST_PRINTF_STACK       64U
+/* Text cell of the stand-in font, glyphs are 5x7 inside it */
+#define HOST_FONT_CELL_WIDTH    6
+#define HOST_FONT_CELL_HEIGHT   8
+
+/*=== C L O C K ===*/
+
+static const std::chrono::steady_clock::time_point koHostStart = std::chrono::steady_clock::now();
+static std::atomic<bool> bVirtualTime(false);
+static std::atomic<uint64_t> nVirtualMicros(0U);
+static uint32_t nRandomState = 0x2545F491U;
+
+static uint64_t hostMicros()
+{
+    if (bVirtualTime) {
+        return nVirtualMicros;
+    }
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - koHostStart).count();
+}
+
+static void hostWaitMicros(uint64_t nMicros)
+{
+    if (bVirtualTime) {
+        nVirtualMicros += nMicros;
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(nMicros));
+}
+
+void hostUseVirtualTime(bool bVirtual)
+{
+    nVirtualMicros = 0U;
+    bVirtualTime = bVirtual;
+}
+
+void hostAdvanceMicros(uint32_t nMicros)
+{
+    nVirtualMicros += nMicros;
+}
+
+void hostSeedRandom(uint32_t nSeed)
+{
+    nRandomState = (nSeed != 0U) ? nSeed : 0x2545F491U;
+}
+
+unsigned long millis() { return (unsigned long)(uint32_t)(hostMicros() / 1000U); }
+unsigned long micros() { return (unsigned long)(uint32_t)hostMicros(); }
+void delay(unsigned long nMillis) { hostWaitMicros((uint64_t)nMillis * 1000U); }
+
+uint32_t esp_random()
+{
+    /* xorshift32, repeatable after hostSeedRandom() */
+    nRandomState ^= nRandomState << 13U;
+    nRandomState ^= nRandomState >> 17U;
+    nRandomState ^= nRandomState << 5U;
+    return nRandomState;
+}
+
+/* Nothing sleeps on the host, the tests decide what happens next */
+void esp_sleep_enable_timer_wakeup(uint64_t nMicros) { (void)nMicros; }
+void esp_deep_sleep_start() {}
+void configTime(long nGmtOffset, int nDaylightOffset, const char *kpcServer1, const char *kpcServer2, const char *kpcServer3)
+{
+    (void)nGmtOffset; (void)nDaylightOffset; (void)kpcServer1; (void)kpcServer2; (void)kpcServer3;
+}
+
+/*=== H E A P ===*/
+
+static std::atomic<bool> bCountingAllocations(false);
+static std::atomic<uint32_t> nAllocations(0U);
+
+void hostCountAllocations(bool bCounting)
+{
+    nAllocations = 0U;
+    bCountingAllocations = bCounting;
+}
+
+uint32_t hostAllocations()
+{
+    return nAllocations;
+}
+
+static void countAllocation()
+{
+    if (bCountingAllocations) {
+        nAllocations++;
+    }
+}
+
+/* Reached through -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc */
+extern "C" {
+void *__real_malloc(size_t nSize);
+void *__real_calloc(size_t nCount, size_t nSize);
+void *__real_realloc(void *pvBlock, size_t nSize);
+
+void *__wrap_malloc(size_t nSize)
+{
+    countAllocation();
+    return __real_malloc(nSize);
+}
+
+void *__wrap_calloc(size_t nCount, size_t nSize)
+{
+    countAllocation();
+    return __real_calloc(nCount, nSize);
+}
+
+void *__wrap_realloc(void *pvBlock, size_t nSize)
+{
+    countAllocation();
+    return __real_realloc(pvBlock, nSize);
+}
+}
+
+/* Global operator new, so C++ allocations anywhere in the program are counted too */
+void *operator new(size_t nSize)
+{
+    countAllocation();
+    void *pvBlock = __real_malloc((nSize > 0U) ? nSize : 1U);
+    if (pvBlock == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pvBlock;
+}
+
+void *operator new[](size_t nSize)
+{
+    return operator new(nSize);
+}
+
+void operator delete(void *pvBlock) noexcept
+{
+    free(pvBlock);
+}
+
+void operator delete[](void *pvBlock) noexcept
+{
+    free(pvBlock);
+}
+
+void operator delete(void *pvBlock, size_t nSize) noexcept
+{
+    (void)nSize;
+    free(pvBlock);
+}
+
+void operator delete[](void *pvBlock, size_t nSize) noexcept
+{
+    (void)nSize;
+    free(pvBlock);
+}
+
+/*=== S T R I N G ===*/
+
+String::String(const char *kpcText) : pcBuffer(nullptr), nLength(0U)
+{
+    copy(kpcText, (kpcText != nullptr) ? (unsigned int)strlen(kpcText) : 0U);
+}
+
+String::String(const String &koOther) : pcBuffer(nullptr), nLength(0U)
+{
+    copy(koOther.c_str(), koOther.nLength);
+}
+
+String::~String()
+{
+    free(pcBuffer);
+}
+
+String &String::operator=(const String &koOther)
+{
+    if (this != &koOther) {
+        copy(koOther.c_str(), koOther.nLength);
+    }
+    return *this;
+}
+
+String &String::operator=(const char *kpcText)
+{
+    copy(kpcText, (kpcText != nullptr) ? (unsigned int)strlen(kpcText) : 0U);
+    return *this;
+}
+
+bool String::operator==(const char *kpcText) const
+{
+    return strcmp(c_str(), (kpcText != nullptr) ? kpcText : "") == 0;
+}
+
+bool String::concat(const char *kpcText)
+{
+    const unsigned int knAdded = (kpcText != nullptr) ? (unsigned int)strlen(kpcText) : 0U;
+    if (knAdded == 0U) {
+        return true;
+    }
+    char *pcGrown = (char *)realloc(pcBuffer, nLength + knAdded + 1U);
+    if (pcGrown == nullptr) {
+        return false;
+    }
+    memcpy(pcGrown + nLength, kpcText, knAdded + 1U);
+    pcBuffer = pcGrown;
+    nLength += knAdded;
+    return true;
+}
+
+void String::copy(const char *kpcText, unsigned int nNewLength)
+{
+    if (nNewLength == 0U) {
+        /* Empty strings don't hold a buffer, as on the device */
+        free(pcBuffer);
+        pcBuffer = nullptr;
+        nLength = 0U;
+        return;
+    }
+    char *pcGrown = (char *)realloc(pcBuffer, nNewLength + 1U);
+    if (pcGrown == nullptr) {
+        return;
+    }
+    pcBuffer = pcGrown;
+    memmove(pcBuffer, kpcText, nNewLength);
+    pcBuffer[nNewLength] = '\0';
+    nLength = nNewLength;
+}
+
+/*=== P R I N T ===*/
+
+size_t Print::write(const uint8_t *kpnBuffer, size_t nSize)
+{
+    size_t nWritten = 0U;
+    while (nSize-- > 0U) {
+        nWritten += write(*kpnBuffer++);
+    }
+    return nWritten;
+}
+
+size_t Print::print(const char *kpcText)
+{
+    return write((const uint8_t *)kpcText, strlen(kpcText));
+}
+
+size_t Print::print(const String &ksText)
+{
+    return write((const uint8_t *)ksText.c_str(), ksText.length());
+}
+
+size_t Print::println(const char *kpcText)
+{
+    return print(kpcText) + print("\r\n");
+}
+
+size_t Print::println(const String &ksText)
+{
+    return print(ksText) + print("\r\n");
+}
+
+size_t Print::printf(const char *kpcFormat, ...)
+{
+    char acStack[HOST_PRINTF_STACK];
+    char *pcText = acStack;
+    va_list oArgs;
+    va_start(oArgs, kpcFormat);
+    const int knLength = vsnprintf(acStack, sizeof(acStack), kpcFormat, oArgs);
+    va_end(oArgs);
+    if (knLength < 0) {
+        return 0U;
+    }
+    if ((size_t)knLength >= sizeof(acStack)) {
+        pcText = (char *)malloc((size_t)knLength + 1U);
+        if (pcText == nullptr) {
+            return 0U;
+        }
+        va_start(oArgs, kpcFormat);
+        vsnprintf(pcText, (size_t)knLength + 1U, kpcFormat, oArgs);
+        va_end(oArgs);
+    }
+    const size_t knWritten = write((const uint8_t *)pcText, (size_t)knLength);
+    if (pcText != acStack) {
+        free(pcText);
+    }
+    return knWritten;
+}
+
+/*=== S E R I A L ===*/
+
+HardwareSerial Serial;
+static std::mutex oSerialMutex;
+static char acSerialCapture[HOST_SERIAL_CAPTURE + 1U];
+static size_t nSerialCaptured = 0U;
+
+void HardwareSerial::begin(unsigned long nBaud)
+{
+    (void)nBaud;
+}
+
+size_t HardwareSerial::write(uint8_t nByte)
+{
+    return write(&nByte, 1U);
+}
+
+size_t HardwareSerial::write(const uint8_t *kpnBuffer, size_t nSize)
+{
+    std::lock_guard<std::mutex> oLock(oSerialMutex);
+    for (size_t n = 0U; n < nSize; n++)
+    {
+        if (nSerialCaptured == HOST_SERIAL_CAPTURE) {
+            /* Full, keep the most recent output */
+            memmove(acSerialCapture, acSerialCapture + 1U, HOST_SERIAL_CAPTURE - 1U);
+            nSerialCaptured--;
+        }
+        acSerialCapture[nSerialCaptured++] = (char)kpnBuffer[n];
+    }
+    acSerialCapture[nSerialCaptured] = '\0';
+    return nSize;
+}
+
+const char *hostSerialOutput()
+{
+    return acSerialCapture;
+}
+
+void hostSerialClear()
+{
+    std::lock_guard<std::mutex> oLock(oSerialMutex);
+    nSerialCaptured = 0U;
+    acSerialCapture[0] = '\0';
+}
+
+/*=== F R E E R T O S ===*/
+
+struct HOST_TASK {
+    std::mutex              oMutex;
+    std::condition_variable oNotified;
+    uint32_t                nNotifications;
+};
+
+struct HOST_MUTEX {
+    std::timed_mutex oMutex;
+};
+
+static thread_local TaskHandle_t oCurrentTask = nullptr;
+static std::atomic<void (*)()> pfMutexTakeHook(nullptr);
+
+void hostOnMutexTake(void (*pfHook)())
+{
+    pfMutexTakeHook = pfHook;
+}
+
+TickType_t xTaskGetTickCount()
+{
+    return (TickType_t)(hostMicros() / (1000000U / configTICK_RATE_HZ));
+}
+
+void vTaskDelay(TickType_t nTicks)
+{
+    hostWaitMicros((uint64_t)nTicks * (1000000U / configTICK_RATE_HZ));
+}
+
+void vTaskDelayUntil(TickType_t *pnPreviousWake, TickType_t nIncrement)
+{
+    const TickType_t knWake = *pnPreviousWake + nIncrement;
+    const int32_t knWait = (int32_t)(knWake - xTaskGetTickCount());
+    if (knWait > 0) {
+        /* Land on the tick edge, as the scheduler would */
+        const uint64_t knTickMicros = 1000000U / configTICK_RATE_HZ;
+        hostWaitMicros(((uint64_t)knWake * knTickMicros) - hostMicros());
+    }
+    *pnPreviousWake = knWake;
+}
+
+BaseType_t xTaskCreatePinnedToCore(void (*pfTask)(void *), const char *kpcName, uint32_t nStackDepth, void *pvParameters,
+                                   UBaseType_t nPriority, TaskHandle_t *poCreated, BaseType_t nCore)
+{
+    (void)kpcName; (void)nStackDepth; (void)nPriority; (void)nCore;
+    TaskHandle_t oTask = new HOST_TASK();
+    oTask->nNotifications = 0U;
+    if (poCreated != nullptr) {
+        *poCreated = oTask;
+    }
+    std::thread([pfTask, pvParameters, oTask]() {
+        oCurrentTask = oTask;
+        pfTask(pvParameters);
+    }).detach();
+    return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    if (oCurrentTask == nullptr) {
+        /* Threads the stand-in didn't start (e.g. the test runner) still get a handle to be notified through */
+        oCurrentTask = new HOST_TASK();
+        oCurrentTask->nNotifications = 0U;
+    }
+    return oCurrentTask;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t oTask)
+{
+    {
+        std::lock_guard<std::mutex> oLock(oTask->oMutex);
+        oTask->nNotifications++;
+    }
+    oTask->oNotified.notify_one();
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t bClearOnExit, TickType_t nTicksToWait)
+{
+    TaskHandle_t oTask = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> oLock(oTask->oMutex);
+    auto kfPending = [oTask]() { return oTask->nNotifications > 0U; };
+    if (nTicksToWait == portMAX_DELAY) {
+        oTask->oNotified.wait(oLock, kfPending);
+    } else {
+        oTask->oNotified.wait_for(oLock, std::chrono::milliseconds(nTicksToWait * portTICK_PERIOD_MS), kfPending);
+    }
+    const uint32_t knCount = oTask->nNotifications;
+    if (knCount > 0U) {
+        oTask->nNotifications = bClearOnExit ? 0U : (knCount - 1U);
+    }
+    return knCount;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    return new HOST_MUTEX();
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t oMutex, TickType_t nTicksToWait)
+{
+    void (*pfHook)() = pfMutexTakeHook;
+    if (pfHook != nullptr) {
+        pfHook();
+    }
+    if (nTicksToWait == portMAX_DELAY) {
+        oMutex->oMutex.lock();
+        return pdTRUE;
+    }
+    return oMutex->oMutex.try_lock_for(std::chrono::milliseconds(nTicksToWait * portTICK_PERIOD_MS)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t oMutex)
+{
+    oMutex->oMutex.unlock();
+    return pdTRUE;
+}
+
+/*=== G F X ===*/
+
+Adafruit_GFX::Adafruit_GFX(int16_t nWidth, int16_t nHeight)
+    : nGfxWidth(nWidth), nGfxHeight(nHeight), nCursorX(0), nCursorY(0), nTextColour(0xFFFFU), nTextSize(1U), bTextWrap(true)
+{
+}
+
+void Adafruit_GFX::fillScreen(uint16_t c)
+{
+    fillRect(0, 0, nGfxWidth, nGfxHeight, c);
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t c)
+{
+    for (int16_t j = y; j < y + h; j++)
+    {
+        for (int16_t i = x; i < x + w; i++)
+        {
+            drawPixel(i, j, c);
+        }
+    }
+}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t c)
+{
+    fillRect(x, y, w, 1, c);
+}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t c)
+{
+    fillRect(x, y, 1, h, c);
+}
+
+void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t c)
+{
+    /* Bresenham, both directions */
+    const int16_t knDx = (int16_t)abs(x1 - x0);
+    const int16_t knDy = (int16_t)-abs(y1 - y0);
+    const int16_t knSx = (x0 < x1) ? 1 : -1;
+    const int16_t knSy = (y0 < y1) ? 1 : -1;
+    int32_t nError = knDx + knDy;
+    for (;;)
+    {
+        drawPixel(x0, y0, c);
+        if ((x0 == x1) && (y0 == y1)) {
+            break;
+        }
+        const int32_t kn2Error = 2 * nError;
+        if (kn2Error >= knDy) {
+            nError += knDy;
+            x0 += knSx;
+        }
+        if (kn2Error <= knDx) {
+            nError += knDx;
+            y0 += knSy;
+        }
+    }
+}
+
+void Adafruit_GFX::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t c)
+{
+    int16_t x = r;
+    int16_t y = 0;
+    int16_t nError = 1 - r;
+    while (x >= y)
+    {
+        drawPixel(x0 + x, y0 + y, c); drawPixel(x0 - x, y0 + y, c);
+        drawPixel(x0 + x, y0 - y, c); drawPixel(x0 - x, y0 - y, c);
+        drawPixel(x0 + y, y0 + x, c); drawPixel(x0 - y, y0 + x, c);
+        drawPixel(x0 + y, y0 - x, c); drawPixel(x0 - y, y0 - x, c);
+        y++;
+        if (nError < 0) {
+            nError += 2 * y + 1;
+        } else {
+            x--;
+            nError += 2 * (y - x) + 1;
+        }
+    }
+}
+
+void Adafruit_GFX::fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t c)
+{
+    for (int16_t y = -r; y <= r; y++)
+    {
+        for (int16_t x = -r; x <= r; x++)
+        {
+            if ((x * x + y * y) <= (r * r + r)) {
+                drawPixel(x0 + x, y0 + y, c);
+            }
+        }
+    }
+}
+
+void Adafruit_GFX::fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t c)
+{
+    /* Every pixel whose centre is inside or on the edges, whichever way the corners wind */
+    const int16_t knLeft = min(x0, min(x1, x2)), knRight = max(x0, max(x1, x2));
+    const int16_t knTop = min(y0, min(y1, y2)), knBottom = max(y0, max(y1, y2));
+    for (int16_t y = knTop; y <= knBottom; y++)
+    {
+        for (int16_t x = knLeft; x <= knRight; x++)
+        {
+            const int32_t knE0 = (int32_t)(x1 - x0) * (y - y0) - (int32_t)(y1 - y0) * (x - x0);
+            const int32_t knE1 = (int32_t)(x2 - x1) * (y - y1) - (int32_t)(y2 - y1) * (x - x1);
+            const int32_t knE2 = (int32_t)(x0 - x2) * (y - y2) - (int32_t)(y0 - y2) * (x - x2);
+            if (((knE0 >= 0) && (knE1 >= 0) && (knE2 >= 0)) || ((knE0 <= 0) && (knE1 <= 0) && (knE2 <= 0))) {
+                drawPixel(x, y, c);
+            }
+        }
+    }
+}
+
+size_t Adafruit_GFX::write(uint8_t nChar)
+{
+    if (nChar == '\n') {
+        nCursorX = 0;
+        nCursorY += HOST_FONT_CELL_HEIGHT * nTextSize;
+        return 1U;
+    }
+    if (nChar == '\r') {
+        return 1U;
+    }
+    if (bTextWrap && ((nCursorX + HOST_FONT_CELL_WIDTH * nTextSize) > nGfxWidth)) {
+        nCursorX = 0;
+        nCursorY += HOST_FONT_CELL_HEIGHT * nTextSize;
+    }
+    drawChar(nCursorX, nCursorY, nChar, nTextColour, nTextSize);
+    nCursorX += HOST_FONT_CELL_WIDTH * nTextSize;
+    return 1U;
+}
+
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, uint8_t nChar, uint16_t c, uint8_t nSize)
+{
+    /* Off-screen characters are skipped whole, as GFX does */
+    if ((x >= nGfxWidth) || (y >= nGfxHeight) || ((x + HOST_FONT_CELL_WIDTH * nSize - 1) < 0) || ((y + HOST_FONT_CELL_HEIGHT * nSize - 1) < 0)) {
+        return;
+    }
+    if (nChar == ' ') {
+        return;
+    }
+    /* Not a real font, just a fixed pattern per character so text lights a repeatable set of pixels */
+    for (int16_t nCol = 0; nCol < 5; nCol++)
+    {
+        for (int16_t nRow = 0; nRow < 7; nRow++)
+        {
+            if (((nChar * 31U + nCol * 7U + nRow * 3U) % 3U) != 0U) {
+                fillRect(x + nCol * nSize, y + nRow * nSize, nSize, nSize, c);
+            }
+        }
+    }
+}
+
+/*=== D R I V E R ===*/
+
+void P3RGB64x32MatrixPanel::drawPixel(int16_t x, int16_t y, uint16_t c)
+{
+    if ((x < 0) || (y < 0) || (x >= (int16_t)HOST_DRIVER_WIDTH) || (y >= (int16_t)HOST_DRIVER_HEIGHT)) {
+        return;
+    }
+    anLit[y][x] = c;
+    nWrites++;
+}
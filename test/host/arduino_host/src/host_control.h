@@ -0,0 +1,54 @@
+//
+// Knobs the native tests turn on the host stand-ins: the clock, the random source & captured serial output.
+//
+
+#ifndef ARDUINO_HOST_HOST_CONTROL_H
+#define ARDUINO_HOST_HOST_CONTROL_H
+
+#include <Arduino.h>
+
+/**
+ * Switches between the host's steady clock & a virtual one that only moves when delayed or advanced,
+ * so timing-dependent code runs instantly & repeatably. Switching resets the virtual clock to 0.
+ * @param bVirtual Use the virtual clock
+ */
+void hostUseVirtualTime(bool bVirtual);
+
+/**
+ * Moves the virtual clock forward, as if that much work had happened
+ * @param nMicros Time to add
+ */
+void hostAdvanceMicros(uint32_t nMicros);
+
+/**
+ * Restarts esp_random() from a known state
+ * @param nSeed Any value
+ */
+void hostSeedRandom(uint32_t nSeed);
+
+/**
+ * Starts or stops counting heap allocations (malloc, calloc, realloc & operator new) made by the sketch, the tests
+ * & these stand-ins, which is what the native env's -Wl,--wrap flags route through here. Starting resets the count.
+ * @param bCounting Count from now on
+ */
+void hostCountAllocations(bool bCounting);
+
+/**
+ * @return Allocations counted since hostCountAllocations(true)
+ */
+uint32_t hostAllocations();
+
+/**
+ * Calls a hook each time a mutex is about to be taken, e.g. to advance the virtual clock as if another task had
+ * held it for a while. Pass nullptr to stop.
+ * @param pfHook Called on the taking thread, before the mutex is granted
+ */
+void hostOnMutexTake(void (*pfHook)());
+
+/**
+ * @return Everything written to Serial since the last hostSerialClear() (the last 4 KB if more)
+ */
+const char *hostSerialOutput();
+void hostSerialClear();
+
+#endif //ARDUINO_HOST_HOST_CONTROL_H
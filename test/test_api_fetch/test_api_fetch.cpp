@@ -0,0 +1,316 @@
+//
+// fetchJSON() against a stand-in server: the per-attempt deadline, retries, backoff, fallback to the cache & the
+// circuit breaker.
+// Runs on the virtual clock, so timeouts & cooldowns take no real time.
+//
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <HTTPClient.h>
+#include <unity.h>
+#include "host_control.h"
+#include "api_fetch.h"
+
+/* Requests the stand-in remembers the timing of */
+#define STANDIN_MAX_REQUESTS    8U
+/* Backoff before retry n (1-based) is jittered within [base << (n-1) / 2, base << (n-1)] */
+#define BACKOFF_MIN(n)          ((FETCH_BACKOFF_BASE << ((n) - 1U)) / 2U)
+#define BACKOFF_MAX(n)          (FETCH_BACKOFF_BASE << ((n) - 1U))
+
+#define GOOD_BODY   "{\"affirmation\":\"You are doing great\"}"
+#define OTHER_BODY  "{\"affirmation\":\"Keep going\"}"
+
+typedef struct STANDIN_SERVER {
+    int         nStatus;                            /* Status every request gets */
+    const char *kpcBody;                            /* Body sent with it */
+    uint32_t    nLatency;                           /* Time to send the status */
+    size_t      nChunkSize;                         /* Body bytes sent at a time */
+    uint32_t    nDripInterval;                      /* Time before each chunk of the body */
+    size_t      nSent;                              /* Body bytes sent for the request in progress */
+    uint8_t     nRequests;                          /* Requests received */
+    uint32_t    anRequestAt[STANDIN_MAX_REQUESTS];  /* millis() each request arrived */
+    uint32_t    anEndAt[STANDIN_MAX_REQUESTS];      /* millis() each connection was closed */
+} standin_server;
+
+static standin_server oServer;
+static api_endpoint oEndpoint;
+static DynamicJsonDocument oDoc(512);
+
+/*
+ * Transport answering from oServer. Like a socket it gives up on a wait longer than the timeout it's handed, but
+ * nothing caps the server itself: however long it takes is up to fetchJSON()'s timeouts.
+ */
+
+static int standInRequest(const char *kpcURL, const uint32_t knTimeout, void *pvContext)
+{
+    (void)kpcURL;
+    standin_server &oStandIn = *(standin_server *)pvContext;
+    if (oStandIn.nRequests < STANDIN_MAX_REQUESTS) {
+        oStandIn.anRequestAt[oStandIn.nRequests] = millis();
+    }
+    oStandIn.nRequests++;
+    oStandIn.nSent = 0U;
+    if (oStandIn.nLatency > knTimeout) {
+        delay(knTimeout);
+        return HTTPC_ERROR_READ_TIMEOUT;
+    }
+    delay(oStandIn.nLatency);
+    return oStandIn.nStatus;
+}
+
+static int standInRead(uint8_t *pnBuffer, const size_t knSize, const uint32_t knTimeout, void *pvContext)
+{
+    standin_server &oStandIn = *(standin_server *)pvContext;
+    const size_t knLeft = strlen(oStandIn.kpcBody) - oStandIn.nSent;
+    if (knLeft == 0U) {
+        return 0;
+    }
+    if (oStandIn.nDripInterval > knTimeout) {
+        delay(knTimeout);
+        return HTTPC_ERROR_READ_TIMEOUT;
+    }
+    delay(oStandIn.nDripInterval);
+    const size_t knRead = min(min(knSize, oStandIn.nChunkSize), knLeft);
+    memcpy(pnBuffer, oStandIn.kpcBody + oStandIn.nSent, knRead);
+    oStandIn.nSent += knRead;
+    return (int)knRead;
+}
+
+static void standInEnd(void *pvContext)
+{
+    standin_server &oStandIn = *(standin_server *)pvContext;
+    if ((oStandIn.nRequests > 0U) && (oStandIn.nRequests <= STANDIN_MAX_REQUESTS)) {
+        oStandIn.anEndAt[oStandIn.nRequests - 1U] = millis();
+    }
+}
+
+static const fetch_transport koStandIn = {standInRequest, standInRead, standInEnd, &oServer};
+
+static void serve(const int knStatus, const char *kpcBody, const uint32_t knLatency)
+{
+    oServer.nStatus = knStatus;
+    oServer.kpcBody = kpcBody;
+    oServer.nLatency = knLatency;
+    oServer.nChunkSize = SIZE_MAX;
+    oServer.nDripInterval = 0U;
+    oServer.nRequests = 0U;
+}
+
+/* Sends the body knChunkSize bytes at a time, knInterval apart */
+static void drip(const size_t knChunkSize, const uint32_t knInterval)
+{
+    oServer.nChunkSize = knChunkSize;
+    oServer.nDripInterval = knInterval;
+}
+
+static fetch_result fetch()
+{
+    return fetchJSON(oEndpoint, oDoc, koStandIn);
+}
+
+/* Sum of the worst-case backoffs between FETCH_ATTEMPTS attempts */
+static uint32_t backoffBound()
+{
+    uint32_t nBound = 0U;
+    for (uint8_t n = 1U; n < FETCH_ATTEMPTS; n++)
+    {
+        nBound += BACKOFF_MAX(n);
+    }
+    return nBound;
+}
+
+static const char *affirmation()
+{
+    return oDoc["affirmation"].as<const char *>();
+}
+
+void setUp()
+{
+    hostUseVirtualTime(true);
+    hostSeedRandom(1U);
+    hostSerialClear();
+    serve(HTTP_CODE_OK, GOOD_BODY, 20U);
+    oEndpoint.kpcURL = "http://standin/affirmation";
+    oEndpoint.sCachedResponse = "";
+    oEndpoint.nFailures = 0U;
+    oEndpoint.nRetryAt = 0U;
+    oDoc.clear();
+}
+
+void tearDown()
+{
+}
+
+/* Trips the breaker with FETCH_BREAKER_TRIPS failing fetches, after caching a good response */
+static void tripBreaker()
+{
+    TEST_ASSERT_EQUAL(FETCH_FRESH, fetch());
+    serve(503, "", 20U);
+    for (uint8_t n = 0U; n < FETCH_BREAKER_TRIPS; n++)
+    {
+        TEST_ASSERT_EQUAL(FETCH_CACHED, fetch());
+    }
+    TEST_ASSERT_EQUAL_UINT8(FETCH_BREAKER_TRIPS, oEndpoint.nFailures);
+}
+
+/*=== T E S T S ===*/
+
+void test_fresh_response_is_parsed_and_cached()
+{
+    TEST_ASSERT_EQUAL(FETCH_FRESH, fetch());
+    TEST_ASSERT_EQUAL_UINT8(1U, oServer.nRequests);
+    TEST_ASSERT_EQUAL_STRING("You are doing great", affirmation());
+    TEST_ASSERT_EQUAL_STRING(GOOD_BODY, oEndpoint.sCachedResponse.c_str());
+    TEST_ASSERT_EQUAL_UINT8(0U, oEndpoint.nFailures);
+}
+
+void test_timeout_retries_with_bounded_backoff()
+{
+    serve(HTTP_CODE_OK, GOOD_BODY, FETCH_ATTEMPT_TIMEOUT + 1000U);
+    const uint32_t knStart = millis();
+    TEST_ASSERT_EQUAL(FETCH_NONE, fetch());
+    TEST_ASSERT_EQUAL_UINT8(FETCH_ATTEMPTS, oServer.nRequests);
+    TEST_ASSERT_TRUE(oDoc.isNull());
+
+    /* Each retry waits out the timeout, then a jittered, doubling backoff */
+    for (uint8_t n = 1U; n < FETCH_ATTEMPTS; n++)
+    {
+        const uint32_t knGap = oServer.anRequestAt[n] - oServer.anRequestAt[n - 1U];
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT32(FETCH_ATTEMPT_TIMEOUT + BACKOFF_MIN(n), knGap);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(FETCH_ATTEMPT_TIMEOUT + BACKOFF_MAX(n), knGap);
+    }
+    /* The whole fetch is bounded, however the server behaves */
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(FETCH_ATTEMPTS * FETCH_ATTEMPT_TIMEOUT + backoffBound(), millis() - knStart);
+    TEST_ASSERT_NOT_NULL(strstr(hostSerialOutput(), "failed: -11"));
+}
+
+void test_slow_drip_body_is_cut_at_the_deadline()
+{
+    /* A quick status, then a body whose every chunk arrives well within the timeout but that takes 4x it in all */
+    static const char kacLongBody[] = "{\"affirmation\":\"You are doing great, and tomorrow you will do even better\"}";
+    const size_t knChunk = 2U;
+    serve(HTTP_CODE_OK, kacLongBody, 20U);
+    drip(knChunk, (4U * FETCH_ATTEMPT_TIMEOUT) / ((sizeof(kacLongBody) - 1U) / knChunk));
+    TEST_ASSERT_LESS_THAN_UINT32(FETCH_ATTEMPT_TIMEOUT / 4U, oServer.nDripInterval);
+
+    const uint32_t knStart = millis();
+    TEST_ASSERT_EQUAL(FETCH_NONE, fetch());
+    TEST_ASSERT_EQUAL_UINT8(FETCH_ATTEMPTS, oServer.nRequests);
+    for (uint8_t n = 0U; n < FETCH_ATTEMPTS; n++)
+    {
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(FETCH_ATTEMPT_TIMEOUT, oServer.anEndAt[n] - oServer.anRequestAt[n]);
+    }
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(FETCH_ATTEMPTS * FETCH_ATTEMPT_TIMEOUT + backoffBound(), millis() - knStart);
+    TEST_ASSERT_NOT_NULL(strstr(hostSerialOutput(), "failed: -11"));
+}
+
+void test_drip_within_the_deadline_is_read_whole()
+{
+    serve(HTTP_CODE_OK, GOOD_BODY, 20U);
+    drip(3U, 50U);
+    TEST_ASSERT_EQUAL(FETCH_FRESH, fetch());
+    TEST_ASSERT_EQUAL_UINT8(1U, oServer.nRequests);
+    TEST_ASSERT_EQUAL_STRING(GOOD_BODY, oEndpoint.sCachedResponse.c_str());
+}
+
+void test_non_200_falls_back_to_cache()
+{
+    TEST_ASSERT_EQUAL(FETCH_FRESH, fetch());
+    serve(500, "{\"affirmation\":\"Internal error\"}", 20U);
+    TEST_ASSERT_EQUAL(FETCH_CACHED, fetch());
+    TEST_ASSERT_EQUAL_UINT8(FETCH_ATTEMPTS, oServer.nRequests);
+    /* The error page's JSON is never shown */
+    TEST_ASSERT_EQUAL_STRING("You are doing great", affirmation());
+    TEST_ASSERT_EQUAL_UINT8(1U, oEndpoint.nFailures);
+}
+
+void test_bad_json_counts_as_failure()
+{
+    TEST_ASSERT_EQUAL(FETCH_FRESH, fetch());
+    serve(HTTP_CODE_OK, "{\"affirmation\":", 20U);
+    TEST_ASSERT_EQUAL(FETCH_CACHED, fetch());
+    TEST_ASSERT_EQUAL_UINT8(FETCH_ATTEMPTS, oServer.nRequests);
+    TEST_ASSERT_EQUAL_STRING("You are doing great", affirmation());
+    /* The truncated body doesn't replace the good one */
+    TEST_ASSERT_EQUAL_STRING(GOOD_BODY, oEndpoint.sCachedResponse.c_str());
+    TEST_ASSERT_EQUAL_UINT8(1U, oEndpoint.nFailures);
+}
+
+void test_success_before_tripping_resets_failures()
+{
+    TEST_ASSERT_EQUAL(FETCH_FRESH, fetch());
+    serve(503, "", 20U);
+    for (uint8_t n = 1U; n < FETCH_BREAKER_TRIPS; n++)
+    {
+        TEST_ASSERT_EQUAL(FETCH_CACHED, fetch());
+    }
+    serve(HTTP_CODE_OK, OTHER_BODY, 20U);
+    TEST_ASSERT_EQUAL(FETCH_FRESH, fetch());
+    TEST_ASSERT_EQUAL_UINT8(0U, oEndpoint.nFailures);
+    TEST_ASSERT_EQUAL_STRING("Keep going", affirmation());
+}
+
+void test_open_breaker_serves_cache_without_requests()
+{
+    tripBreaker();
+    serve(HTTP_CODE_OK, OTHER_BODY, 20U);
+    const uint32_t knStart = millis();
+    TEST_ASSERT_EQUAL(FETCH_CACHED, fetch());
+    TEST_ASSERT_EQUAL_UINT8(0U, oServer.nRequests);
+    TEST_ASSERT_EQUAL_UINT32(knStart, millis());
+    TEST_ASSERT_EQUAL_STRING("You are doing great", affirmation());
+
+    /* Still open just before the cooldown ends */
+    delay(FETCH_BREAKER_COOLDOWN - 1000U);
+    TEST_ASSERT_EQUAL(FETCH_CACHED, fetch());
+    TEST_ASSERT_EQUAL_UINT8(0U, oServer.nRequests);
+}
+
+void test_half_open_trial_failure_reopens()
+{
+    tripBreaker();
+    oServer.nRequests = 0U;
+    delay(FETCH_BREAKER_COOLDOWN);
+    /* One trial request, not a full set of retries */
+    TEST_ASSERT_EQUAL(FETCH_CACHED, fetch());
+    TEST_ASSERT_EQUAL_UINT8(1U, oServer.nRequests);
+    TEST_ASSERT_EQUAL_UINT8(FETCH_BREAKER_TRIPS, oEndpoint.nFailures);
+
+    /* Open for a whole cooldown again */
+    oServer.nRequests = 0U;
+    delay(FETCH_BREAKER_COOLDOWN - 1000U);
+    TEST_ASSERT_EQUAL(FETCH_CACHED, fetch());
+    TEST_ASSERT_EQUAL_UINT8(0U, oServer.nRequests);
+}
+
+void test_half_open_trial_success_closes()
+{
+    tripBreaker();
+    delay(FETCH_BREAKER_COOLDOWN);
+    serve(HTTP_CODE_OK, OTHER_BODY, 20U);
+    TEST_ASSERT_EQUAL(FETCH_FRESH, fetch());
+    TEST_ASSERT_EQUAL_UINT8(1U, oServer.nRequests);
+    TEST_ASSERT_EQUAL_UINT8(0U, oEndpoint.nFailures);
+    TEST_ASSERT_EQUAL_STRING("Keep going", affirmation());
+
+    /* Closed, so the next failure gets every attempt again */
+    serve(503, "", 20U);
+    TEST_ASSERT_EQUAL(FETCH_CACHED, fetch());
+    TEST_ASSERT_EQUAL_UINT8(FETCH_ATTEMPTS, oServer.nRequests);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fresh_response_is_parsed_and_cached);
+    RUN_TEST(test_timeout_retries_with_bounded_backoff);
+    RUN_TEST(test_slow_drip_body_is_cut_at_the_deadline);
+    RUN_TEST(test_drip_within_the_deadline_is_read_whole);
+    RUN_TEST(test_non_200_falls_back_to_cache);
+    RUN_TEST(test_bad_json_counts_as_failure);
+    RUN_TEST(test_success_before_tripping_resets_failures);
+    RUN_TEST(test_open_breaker_serves_cache_without_requests);
+    RUN_TEST(test_half_open_trial_failure_reopens);
+    RUN_TEST(test_half_open_trial_success_closes);
+    return UNITY_END();
+}
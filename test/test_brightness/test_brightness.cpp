@@ -0,0 +1,169 @@
+//
+// Brightness schedule & palette swaps: the level at each step's boundary, dimming changing only what the driver is
+// given (never the shadow the mirror reads), and what a swap costs the driver.
+//
+
+#include <Arduino.h>
+#include <unity.h>
+#include <stdio.h>
+#include "host_control.h"
+#include "time_zone_rules.h"
+#include "colour_palette.h"
+#include "shadow_panel.h"
+
+/* From main.cpp */
+extern SemaphoreHandle_t oLEDMatrixMutex;
+extern ShadowMatrixPanel matrix;
+uint8_t scheduledBrightness(const local_time &koNow);
+void applyScheduledBrightness(const local_time &koNow);
+
+/* Where the test pixels go, away from each other */
+#define TEST_X      5
+#define TEST_Y      7
+
+static ShadowMatrixPanel oPanel;
+static uint8_t anMirror[MIRROR_MAX_FRAME_SIZE];
+
+/**
+ * @return An ordinary Wednesday at hh:mm
+ */
+static local_time at(const uint8_t knHour, const uint8_t knMinute)
+{
+    const local_time koTime = {2022, 10U, 19U, knHour, knMinute, 0U, TZ_WEDNESDAY, true};
+    return koTime;
+}
+
+/**
+ * @return Driver colour a 0x0RGB colour should get at a level
+ */
+static uint16_t expectedDriver(const uint8_t knLevel, const uint16_t kn444)
+{
+    return oPanel.color555(kanBrightnessTable[knLevel][(kn444 >> 8U) & 0xFU], kanBrightnessTable[knLevel][(kn444 >> 4U) & 0xFU],
+                           kanBrightnessTable[knLevel][kn444 & 0xFU]);
+}
+
+static uint16_t lit(const int16_t x, const int16_t y)
+{
+    return oPanel.litPixel(panelChainX(x, y), panelChainY(y));
+}
+
+void setUp()
+{
+    oPanel.setBrightness(BRIGHTNESS_100);
+    oPanel.fillScreen(0U);
+    /* Nothing pending for the mirror */
+    oPanel.encodeMirrorFrame(anMirror, false);
+}
+
+void tearDown()
+{
+}
+
+/*=== T E S T S ===*/
+
+void test_schedule_boundaries()
+{
+    /* Before 07:00 it's still the night before's last step */
+    TEST_ASSERT_EQUAL_UINT8(BRIGHTNESS_30, scheduledBrightness(at(0U, 0U)));
+    TEST_ASSERT_EQUAL_UINT8(BRIGHTNESS_30, scheduledBrightness(at(6U, 59U)));
+    TEST_ASSERT_EQUAL_UINT8(BRIGHTNESS_70, scheduledBrightness(at(7U, 0U)));
+    TEST_ASSERT_EQUAL_UINT8(BRIGHTNESS_70, scheduledBrightness(at(7U, 59U)));
+    TEST_ASSERT_EQUAL_UINT8(BRIGHTNESS_100, scheduledBrightness(at(8U, 0U)));
+    TEST_ASSERT_EQUAL_UINT8(BRIGHTNESS_100, scheduledBrightness(at(17U, 59U)));
+    TEST_ASSERT_EQUAL_UINT8(BRIGHTNESS_85, scheduledBrightness(at(18U, 0U)));
+    TEST_ASSERT_EQUAL_UINT8(BRIGHTNESS_55, scheduledBrightness(at(20U, 0U)));
+    TEST_ASSERT_EQUAL_UINT8(BRIGHTNESS_55, scheduledBrightness(at(21U, 29U)));
+    TEST_ASSERT_EQUAL_UINT8(BRIGHTNESS_40, scheduledBrightness(at(21U, 30U)));
+    TEST_ASSERT_EQUAL_UINT8(BRIGHTNESS_40, scheduledBrightness(at(22U, 29U)));
+    TEST_ASSERT_EQUAL_UINT8(BRIGHTNESS_30, scheduledBrightness(at(22U, 30U)));
+    TEST_ASSERT_EQUAL_UINT8(BRIGHTNESS_30, scheduledBrightness(at(23U, 59U)));
+}
+
+void test_apply_only_swaps_on_a_change()
+{
+    applyScheduledBrightness(at(21U, 30U));
+    TEST_ASSERT_EQUAL_UINT8(BRIGHTNESS_40, matrix.brightness());
+    /* Same level a minute later: the driver isn't touched */
+    const uint32_t knWrites = matrix.driverWrites();
+    applyScheduledBrightness(at(21U, 31U));
+    TEST_ASSERT_EQUAL_UINT32(knWrites, matrix.driverWrites());
+    applyScheduledBrightness(at(8U, 0U));
+    TEST_ASSERT_EQUAL_UINT8(BRIGHTNESS_100, matrix.brightness());
+}
+
+void test_dimming_changes_the_driver_not_the_shadow()
+{
+    oPanel.drawPixel(TEST_X, TEST_Y, oPanel.from444(COLOUR_GREY));
+    oPanel.drawPixel(TEST_X + 2, TEST_Y, oPanel.from444(COLOUR_TODO));
+    oPanel.encodeMirrorFrame(anMirror, false);
+    TEST_ASSERT_EQUAL_HEX16(expectedDriver(BRIGHTNESS_100, COLOUR_GREY), lit(TEST_X, TEST_Y));
+
+    oPanel.setBrightness(BRIGHTNESS_40);
+    TEST_ASSERT_EQUAL_HEX16(expectedDriver(BRIGHTNESS_40, COLOUR_GREY), lit(TEST_X, TEST_Y));
+    TEST_ASSERT_EQUAL_HEX16(expectedDriver(BRIGHTNESS_40, COLOUR_TODO), lit(TEST_X + 2, TEST_Y));
+    TEST_ASSERT_NOT_EQUAL(lit(TEST_X, TEST_Y), expectedDriver(BRIGHTNESS_100, COLOUR_GREY));
+    /* The shadow still holds the colours as drawn, so the mirror has nothing to send */
+    TEST_ASSERT_EQUAL_UINT32(0U, oPanel.encodeMirrorFrame(anMirror, false));
+
+    /* New drawing comes out at the new level, including the colour drawPixel() converted last */
+    oPanel.drawPixel(TEST_X + 4, TEST_Y, oPanel.from444(COLOUR_TODO));
+    oPanel.drawPixel(TEST_X + 6, TEST_Y, oPanel.from444(COLOUR_WHITE));
+    TEST_ASSERT_EQUAL_HEX16(expectedDriver(BRIGHTNESS_40, COLOUR_TODO), lit(TEST_X + 4, TEST_Y));
+    TEST_ASSERT_EQUAL_HEX16(expectedDriver(BRIGHTNESS_40, COLOUR_WHITE), lit(TEST_X + 6, TEST_Y));
+
+    /* And back up, exactly as drawn */
+    oPanel.setBrightness(BRIGHTNESS_100);
+    TEST_ASSERT_EQUAL_HEX16(expectedDriver(BRIGHTNESS_100, COLOUR_GREY), lit(TEST_X, TEST_Y));
+    TEST_ASSERT_EQUAL_HEX16(expectedDriver(BRIGHTNESS_100, COLOUR_WHITE), lit(TEST_X + 6, TEST_Y));
+}
+
+void test_dim_levels_keep_five_bit_steps()
+{
+    /* Adjacent 4-bit values still differ on the driver where a 4-bit table would have merged them */
+    TEST_ASSERT_EQUAL_UINT8(PALETTE_DRIVER_MAX, kanBrightnessTable[BRIGHTNESS_100][PALETTE_CHANNEL_STEPS - 1U]);
+    TEST_ASSERT_NOT_EQUAL(expectedDriver(BRIGHTNESS_70, 0x800U), expectedDriver(BRIGHTNESS_70, 0x700U));
+    TEST_ASSERT_NOT_EQUAL(expectedDriver(BRIGHTNESS_30, COLOUR_GREY), expectedDriver(BRIGHTNESS_30, COLOUR_WHITE));
+}
+
+void test_swap_repaints_only_lit_pixels()
+{
+    /* The driver can't dim globally, so a swap costs one write per lit pixel: measure it on a busy panel */
+    uint32_t nLit = 0U;
+    for (uint8_t y = 0U; y < PANEL_HEIGHT; y++)
+    {
+        for (uint8_t x = 0U; x < PANEL_WIDTH; x++)
+        {
+            if (((x + y) % 3U) == 0U) {
+                oPanel.drawPixel(x, y, oPanel.from444(kanNamedColours[1U + (x / 8U) % (NAMED_COLOUR_COUNT - 1U)]));
+                nLit++;
+            }
+        }
+    }
+    const uint32_t knWrites = oPanel.driverWrites();
+    const uint32_t knStart = micros();
+    oPanel.setBrightness(BRIGHTNESS_55);
+    const uint32_t knSwapUs = micros() - knStart;
+    TEST_ASSERT_EQUAL_UINT32(nLit, oPanel.driverWrites() - knWrites);
+    printf("Brightness swap %ux%u: %u of %u px redrawn, %u us on the host\n", (unsigned)PANEL_WIDTH, (unsigned)PANEL_HEIGHT,
+           (unsigned)nLit, (unsigned)(PANEL_WIDTH * PANEL_HEIGHT), (unsigned)knSwapUs);
+
+    /* Swapping to the level already shown costs nothing */
+    const uint32_t knWritesAfter = oPanel.driverWrites();
+    oPanel.setBrightness(BRIGHTNESS_55);
+    TEST_ASSERT_EQUAL_UINT32(knWritesAfter, oPanel.driverWrites());
+}
+
+int main()
+{
+    oPanel.begin();
+    oLEDMatrixMutex = xSemaphoreCreateMutex();
+    matrix.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_schedule_boundaries);
+    RUN_TEST(test_apply_only_swaps_on_a_change);
+    RUN_TEST(test_dimming_changes_the_driver_not_the_shadow);
+    RUN_TEST(test_dim_levels_keep_five_bit_steps);
+    RUN_TEST(test_swap_repaints_only_lit_pixels);
+    return UNITY_END();
+}
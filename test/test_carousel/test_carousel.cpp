@@ -0,0 +1,184 @@
+//
+// Carousel pacing on the virtual clock: every position drawn when on time, catching up after an overrun without
+// sleeping an extra frame, resuming after a stall by at most CAROUSEL_MAX_SKIP, and always ending on a clear region.
+// Overruns are injected as time spent waiting for the matrix mutex.
+//
+
+#include <Arduino.h>
+#include <unity.h>
+#include <stdio.h>
+#include "host_control.h"
+#include "panel_layout.h"
+#include "text_view.h"
+#include "shadow_panel.h"
+
+/* From main.cpp */
+extern SemaphoreHandle_t oLEDMatrixMutex;
+extern ShadowMatrixPanel matrix;
+void cycleMessage(const text_view koMessage, const uint32_t knPixelsPerSecond);
+void printCarouselStats();
+
+/* As main.cpp runs the carousel */
+#define CAROUSEL_SPEED      66U
+#define CAROUSEL_MAX_SKIP   4U
+#define FRAME_MICROS        ((1000U / CAROUSEL_SPEED) * 1000U)
+/* Frame the overrun & stall tests hold the matrix before */
+#define LATE_FRAME          20U
+/* An overrun a few pixels long, & a stall far longer than CAROUSEL_MAX_SKIP pixels */
+#define OVERRUN_MICROS      40000U
+#define STALL_MICROS        2000000U
+/* Most matrix takes a run records the time of */
+#define MAX_TAKES           512U
+
+static const char kacMessage[] = "You are doing great today";
+/* Positions from just past the right edge to fully scrolled out, each drawn or skipped */
+#define POSITIONS           (PANEL_WIDTH + (sizeof(kacMessage) - 1U) * TEXT_WIDTH + 1U)
+
+/* Carousel counters as printCarouselStats() reports them */
+typedef struct STATS_SNAPSHOT {
+    unsigned    nFrames;
+    unsigned    nMissed;
+    unsigned    nSkipped;
+    unsigned    nLastJitter;
+    unsigned    nMaxJitter;
+} stats_snapshot;
+
+/* What the mutex hook does & saw */
+static uint32_t nTakes;
+static uint32_t nLateTake;
+static uint32_t nLateMicros;
+static uint32_t anTakeMicros[MAX_TAKES];
+/* Frames a run with nothing late takes */
+static uint32_t nOnTimeTakes;
+
+static void onMutexTake()
+{
+    if (nTakes == nLateTake) {
+        hostAdvanceMicros(nLateMicros);
+    }
+    if (nTakes < MAX_TAKES) {
+        anTakeMicros[nTakes] = micros();
+    }
+    nTakes++;
+}
+
+static stats_snapshot readStats()
+{
+    stats_snapshot oStats = {0U, 0U, 0U, 0U, 0U};
+    hostSerialClear();
+    printCarouselStats();
+    TEST_ASSERT_EQUAL_INT(5, sscanf(hostSerialOutput(), "Carousel: %u frames, %u missed deadlines Carousel: %u skipped px "
+                                    "Carousel jitter: %u us (max %u us)", &oStats.nFrames, &oStats.nMissed, &oStats.nSkipped,
+                                    &oStats.nLastJitter, &oStats.nMaxJitter));
+    return oStats;
+}
+
+/**
+ * Scrolls the message once, holding the matrix for knLateMicros before frame knLateTake
+ * @return Counters this run added
+ */
+static stats_snapshot scroll(const uint32_t knLateTake, const uint32_t knLateMicros)
+{
+    const stats_snapshot koBefore = readStats();
+    nTakes = 0U;
+    nLateTake = knLateTake;
+    nLateMicros = knLateMicros;
+    hostOnMutexTake(onMutexTake);
+    cycleMessage(textView(kacMessage), CAROUSEL_SPEED);
+    hostOnMutexTake(nullptr);
+    const stats_snapshot koAfter = readStats();
+    const stats_snapshot koRun = {koAfter.nFrames - koBefore.nFrames, koAfter.nMissed - koBefore.nMissed,
+                                  koAfter.nSkipped - koBefore.nSkipped, koAfter.nLastJitter, koAfter.nMaxJitter};
+    return koRun;
+}
+
+static bool carouselClear()
+{
+    const layout_region &koRegion = kaoLayout[REGION_CAROUSEL];
+    for (int16_t y = koRegion.nTop; y < (koRegion.nTop + koRegion.nHeight); y++)
+    {
+        for (int16_t x = koRegion.nLeft; x < (koRegion.nLeft + koRegion.nWidth); x++)
+        {
+            if (matrix.litPixel(panelChainX(x, y), panelChainY(y)) != 0U) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void setUp()
+{
+    hostUseVirtualTime(true);
+    xSemaphoreTake(oLEDMatrixMutex, portMAX_DELAY);
+    matrix.fillScreen(0U);
+    xSemaphoreGive(oLEDMatrixMutex);
+}
+
+void tearDown()
+{
+    hostOnMutexTake(nullptr);
+}
+
+/*=== T E S T S ===*/
+
+void test_on_time_draws_every_position()
+{
+    const stats_snapshot koRun = scroll(UINT32_MAX, 0U);
+    TEST_ASSERT_EQUAL_UINT32(POSITIONS, koRun.nFrames);
+    TEST_ASSERT_EQUAL_UINT32(0U, koRun.nMissed);
+    TEST_ASSERT_EQUAL_UINT32(0U, koRun.nSkipped);
+    TEST_ASSERT_EQUAL_UINT32(0U, koRun.nMaxJitter);
+    TEST_ASSERT_TRUE(carouselClear());
+    nOnTimeTakes = nTakes;
+}
+
+void test_overrun_catches_up_without_an_extra_frame()
+{
+    const stats_snapshot koRun = scroll(LATE_FRAME, OVERRUN_MICROS);
+    TEST_ASSERT_EQUAL_UINT32(1U, koRun.nMissed);
+    /* Position follows the time: the pixels the overrun covered are jumped (rounding either way), then every position again */
+    TEST_ASSERT_UINT32_WITHIN(1U, (OVERRUN_MICROS * CAROUSEL_SPEED) / 1000000U - 1U, koRun.nSkipped);
+    TEST_ASSERT_EQUAL_UINT32(POSITIONS, koRun.nFrames + koRun.nSkipped);
+    /* The late frame goes straight on to the next, rather than sleeping a frame first */
+    TEST_ASSERT_LESS_THAN_UINT32(FRAME_MICROS, anTakeMicros[LATE_FRAME + 1U] - anTakeMicros[LATE_FRAME]);
+    /* Late by the overrun, less the frame it had anyway */
+    TEST_ASSERT_EQUAL_UINT32(OVERRUN_MICROS - FRAME_MICROS, koRun.nMaxJitter);
+    TEST_ASSERT_TRUE(carouselClear());
+}
+
+void test_stall_resumes_by_at_most_max_skip()
+{
+    const stats_snapshot koRun = scroll(LATE_FRAME, STALL_MICROS);
+    TEST_ASSERT_EQUAL_UINT32(1U, koRun.nMissed);
+    TEST_ASSERT_EQUAL_UINT32(CAROUSEL_MAX_SKIP, koRun.nSkipped);
+    TEST_ASSERT_EQUAL_UINT32(POSITIONS, koRun.nFrames + koRun.nSkipped);
+    TEST_ASSERT_LESS_THAN_UINT32(FRAME_MICROS, anTakeMicros[LATE_FRAME + 1U] - anTakeMicros[LATE_FRAME]);
+    TEST_ASSERT_TRUE(carouselClear());
+}
+
+void test_jump_past_the_end_still_clears_the_region()
+{
+    /* Stall on each of the last frames in turn, so the catch-up lands past the end */
+    TEST_ASSERT_GREATER_THAN_UINT32(CAROUSEL_MAX_SKIP + 2U, nOnTimeTakes);
+    for (uint32_t nFromEnd = 2U; nFromEnd <= (CAROUSEL_MAX_SKIP + 2U); nFromEnd++)
+    {
+        setUp();
+        const stats_snapshot koRun = scroll(nOnTimeTakes - nFromEnd, STALL_MICROS);
+        TEST_ASSERT_EQUAL_UINT32(POSITIONS, koRun.nFrames + koRun.nSkipped);
+        TEST_ASSERT_TRUE_MESSAGE(carouselClear(), "Text left behind in the carousel region");
+    }
+}
+
+int main()
+{
+    oLEDMatrixMutex = xSemaphoreCreateMutex();
+    matrix.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_on_time_draws_every_position);
+    RUN_TEST(test_overrun_catches_up_without_an_extra_frame);
+    RUN_TEST(test_stall_resumes_by_at_most_max_skip);
+    RUN_TEST(test_jump_past_the_end_still_clears_the_region);
+    return UNITY_END();
+}
@@ -0,0 +1,425 @@
+//
+// Mirror frames: worst-case size against MIRROR_MAX_FRAME_SIZE, round trips through a reference decoder & through
+// tools/panel_mirror.py, the overhead of mirroring the sketch's own carousel, and the sketch keeping its hands off the
+// panel while the encoder holds it.
+//
+
+#include <Arduino.h>
+#include <unity.h>
+#include <stdio.h>
+#include <thread>
+#include "host_control.h"
+#include "time_zone_rules.h"
+#include "panel_layout.h"
+#include "text_view.h"
+#include "shadow_panel.h"
+
+/* From main.cpp */
+extern SemaphoreHandle_t oLEDMatrixMutex;
+extern ShadowMatrixPanel matrix;
+void blankAndDrawTime(const local_time &koNow);
+void cycleMessage(const text_view koMessage, const uint32_t knPixelsPerSecond);
+
+/* Guard bytes after the frame buffer, any write past MIRROR_MAX_FRAME_SIZE lands here */
+#define CANARY_SIZE         64U
+#define CANARY_BYTE         0xA5U
+/* Random change patterns tried against the bound */
+#define FUZZ_FRAMES         200U
+/* Frames in a round trip session, with a keyframe & a full blank every so often */
+#define SESSION_FRAMES      400U
+#define SESSION_KEYFRAMES   150U
+#define SESSION_BLANKS      97U
+/* Carousel speed & serial speed the overhead is measured at, as main.cpp runs them (the mirror keeps pace with the carousel) */
+#define CAROUSEL_SPEED      66U
+#define MIRROR_BAUD         921600U
+/* How long the test holds the matrix, as the mirror task would while encoding (real milliseconds) */
+#define HOLD_MILLIS         50U
+/* Where the decoder end-to-end test leaves its files, under the PlatformIO build directory */
+#define SESSION_RECORDING   ".pio/test_mirror_session.pmr"
+#define SESSION_IMAGE       ".pio/test_mirror_session.ppm"
+#define DECODER_SCRIPT      "tools/panel_mirror.py"
+#define DECODER_COMMAND     "python3 tools/panel_mirror.py --quiet --ppm " SESSION_IMAGE " replay " SESSION_RECORDING " --speed 0"
+
+static ShadowMatrixPanel oPanel;
+static uint8_t anBuffer[MIRROR_MAX_FRAME_SIZE + CANARY_SIZE];
+/* What the reference decoder has rebuilt (0x0RGB) */
+static uint16_t anDecoded[PANEL_HEIGHT][PANEL_WIDTH];
+
+/* Mirror frames encoded from the sketch's matrix while it runs the carousel */
+typedef struct MIRROR_RUN {
+    uint32_t    nFrames;        /* Frames encoded */
+    uint32_t    nBytes;         /* Bytes they took */
+    uint32_t    nMaxFrame;      /* Largest frame */
+    bool        bWellFormed;    /* Every frame fitted the bound & decoded */
+} mirror_run;
+
+static mirror_run oMirrorRun;
+
+static bool canaryIntact()
+{
+    for (uint16_t n = MIRROR_MAX_FRAME_SIZE; n < sizeof(anBuffer); n++)
+    {
+        if (anBuffer[n] != CANARY_BYTE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Encodes the pending changes into anBuffer, behind a fresh canary
+ * @return Frame size
+ */
+static uint16_t encode(ShadowMatrixPanel &oFrom, const bool kbKeyframe)
+{
+    memset(anBuffer, CANARY_BYTE, sizeof(anBuffer));
+    return oFrom.encodeMirrorFrame(anBuffer, kbKeyframe);
+}
+
+/**
+ * Encodes the pending changes, checking they stayed inside the bound
+ * @return Frame size
+ */
+static uint16_t encodeChecked(const bool kbKeyframe = false, ShadowMatrixPanel &oFrom = oPanel)
+{
+    const uint16_t knSize = encode(oFrom, kbKeyframe);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(MIRROR_MAX_FRAME_SIZE, knSize);
+    TEST_ASSERT_TRUE_MESSAGE(canaryIntact(), "Encoder wrote past MIRROR_MAX_FRAME_SIZE");
+    return knSize;
+}
+
+/**
+ * Reference decoder, written from the format description in shadow_panel.h rather than the encoder
+ * @return Whether the frame was well formed (it's only applied if so)
+ */
+static bool decodeFrame(const uint8_t *kpnFrame, const uint16_t knSize)
+{
+    if ((knSize < (MIRROR_HEADER_SIZE + 1U)) || (kpnFrame[0] != MIRROR_MAGIC_0) || (kpnFrame[1] != MIRROR_MAGIC_1)
+        || (kpnFrame[4] != PANEL_WIDTH) || (kpnFrame[5] != PANEL_HEIGHT)) {
+        return false;
+    }
+    uint8_t nChecksum = 0U;
+    for (uint16_t n = 2U; n < (knSize - 1U); n++)
+    {
+        nChecksum += kpnFrame[n];
+    }
+    if (nChecksum != kpnFrame[knSize - 1U]) {
+        return false;
+    }
+
+    /* Walk the spans once to check them, then again to apply them */
+    const uint16_t knSpans = kpnFrame[6] | (kpnFrame[7] << 8U);
+    for (uint8_t nPass = 0U; nPass < 2U; nPass++)
+    {
+        uint16_t nPos = MIRROR_HEADER_SIZE;
+        for (uint16_t nSpan = 0U; nSpan < knSpans; nSpan++)
+        {
+            if ((nPos + MIRROR_SPAN_HEADER_SIZE) > (knSize - 1U)) {
+                return false;
+            }
+            const uint8_t knRow = kpnFrame[nPos], knCol = kpnFrame[nPos + 1U], knLength = kpnFrame[nPos + 2U];
+            nPos += MIRROR_SPAN_HEADER_SIZE;
+            const uint16_t knPacked = (knLength * 3U + 1U) / 2U;
+            if ((knRow >= PANEL_HEIGHT) || (knLength == 0U) || ((knCol + knLength) > PANEL_WIDTH) || ((nPos + knPacked) > (knSize - 1U))) {
+                return false;
+            }
+            for (uint8_t i = 0U; (nPass == 1U) && (i < knLength); i++)
+            {
+                /* Pixel pairs are 0xRG 0xBR 0xGB */
+                const uint8_t *kpnPair = &kpnFrame[nPos + (i / 2U) * 3U];
+                anDecoded[knRow][knCol + i] = ((i & 1U) == 0U) ? (uint16_t)((kpnPair[0] << 4U) | (kpnPair[1] >> 4U))
+                                                               : (uint16_t)(((kpnPair[1] & 0xFU) << 8U) | kpnPair[2]);
+            }
+            nPos += knPacked;
+        }
+        if (nPos != (knSize - 1U)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * What the panel shows at a board position, read back from the driver as 0x0RGB (full brightness)
+ */
+static uint16_t shown(const ShadowMatrixPanel &koPanel, const uint8_t x, const uint8_t y)
+{
+    const uint16_t knDriver = koPanel.litPixel(panelChainX(x, y), panelChainY(y));
+    uint16_t n444 = 0U;
+    for (uint8_t nChannel = 0U; nChannel < 3U; nChannel++)
+    {
+        /* Find each channel through color444() rather than assuming the driver's bit layout */
+        const uint16_t knUnit = koPanel.color444(nChannel == 0U, nChannel == 1U, nChannel == 2U);
+        n444 |= ((knDriver / knUnit) & 0xFU) << (8U - 4U * nChannel);
+    }
+    return n444;
+}
+
+static bool decodedMatchesPanel(const ShadowMatrixPanel &koFrom = oPanel)
+{
+    for (uint8_t y = 0U; y < PANEL_HEIGHT; y++)
+    {
+        for (uint8_t x = 0U; x < PANEL_WIDTH; x++)
+        {
+            if (anDecoded[y][x] != shown(koFrom, x, y)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static uint16_t randomColour()
+{
+    return oPanel.color444(esp_random() % 16U, esp_random() % 16U, esp_random() % 16U);
+}
+
+/**
+ * A frame of random drawing, as scattered as the panel sees: the odd full blank & a few dozen pixels
+ */
+static void drawRandomFrame(const uint16_t knFrame)
+{
+    if ((knFrame % SESSION_BLANKS) == 5U) {
+        oPanel.fillScreen(randomColour());
+    }
+    const uint8_t knPixels = esp_random() % 60U;
+    for (uint8_t n = 0U; n < knPixels; n++)
+    {
+        oPanel.drawPixel(esp_random() % PANEL_WIDTH, esp_random() % PANEL_HEIGHT, randomColour());
+    }
+}
+
+/**
+ * Mirrors what the sketch drew since the last call, as the mirror task would in step with the carousel. Runs inside
+ * xSemaphoreTake(), so it notes failures rather than asserting.
+ */
+static void mirrorMatrix()
+{
+    const uint16_t knSize = encode(matrix, false);
+    oMirrorRun.bWellFormed &= (knSize <= MIRROR_MAX_FRAME_SIZE) && canaryIntact() && ((knSize == 0U) || decodeFrame(anBuffer, knSize));
+    oMirrorRun.nFrames++;
+    oMirrorRun.nBytes += knSize;
+    oMirrorRun.nMaxFrame = max(oMirrorRun.nMaxFrame, (uint32_t)knSize);
+}
+
+static void writeRecord(FILE *poRecording, const double kdStamp, const void *kpvData, const uint32_t knLength)
+{
+    /* Little-endian double & uint32, as struct.pack("<dI") reads them */
+    fwrite(&kdStamp, sizeof(kdStamp), 1U, poRecording);
+    fwrite(&knLength, sizeof(knLength), 1U, poRecording);
+    fwrite(kpvData, 1U, knLength, poRecording);
+}
+
+void setUp()
+{
+    /* Start every test in sync with the decoder, on a black panel */
+    hostSeedRandom(30U);
+    oPanel.fillScreen(0U);
+    TEST_ASSERT_TRUE(decodeFrame(anBuffer, oPanel.encodeMirrorFrame(anBuffer, true)));
+}
+
+void tearDown()
+{
+    hostOnMutexTake(nullptr);
+}
+
+/*=== T E S T S ===*/
+
+void test_keyframe_fits()
+{
+    const uint16_t knSize = encodeChecked(true);
+    TEST_ASSERT_EQUAL_UINT32(MIRROR_HEADER_SIZE + PANEL_HEIGHT * (MIRROR_SPAN_HEADER_SIZE + (PANEL_WIDTH * 3U + 1U) / 2U) + 1U, knSize);
+}
+
+void test_every_third_column_fits()
+{
+    /* A lone changed pixel every third column is as fragmented as a row gets */
+    for (uint8_t y = 0U; y < PANEL_HEIGHT; y++)
+    {
+        for (uint8_t x = 0U; x < PANEL_WIDTH; x += MIRROR_SPAN_GAP + 1U)
+        {
+            oPanel.drawPixel(x, y, oPanel.color444(15U, 8U, 1U));
+        }
+    }
+    const uint16_t knSize = encodeChecked();
+    /* Every row splits into the most spans it can hold */
+    TEST_ASSERT_EQUAL_UINT32(MIRROR_ROW_MAX_SPANS * PANEL_HEIGHT, (uint32_t)anBuffer[6] | ((uint32_t)anBuffer[7] << 8U));
+    TEST_ASSERT_EQUAL_UINT32(MIRROR_HEADER_SIZE + PANEL_HEIGHT * MIRROR_ROW_MAX_SPANS * (MIRROR_SPAN_HEADER_SIZE + 2U) + 1U, knSize);
+    TEST_ASSERT_TRUE(decodeFrame(anBuffer, knSize));
+    TEST_ASSERT_TRUE(decodedMatchesPanel());
+}
+
+void test_pixel_pairs_every_fourth_column_fit()
+{
+    for (uint8_t y = 0U; y < PANEL_HEIGHT; y++)
+    {
+        for (uint8_t x = 0U; (x + 1U) < PANEL_WIDTH; x += MIRROR_SPAN_GAP + 2U)
+        {
+            oPanel.drawPixel(x, y, oPanel.color444(1U, 2U, 3U));
+            oPanel.drawPixel(x + 1U, y, oPanel.color444(1U, 2U, 3U));
+        }
+    }
+    TEST_ASSERT_TRUE(decodeFrame(anBuffer, encodeChecked()));
+    TEST_ASSERT_TRUE(decodedMatchesPanel());
+}
+
+void test_random_changes_fit()
+{
+    for (uint16_t nFrame = 0U; nFrame < FUZZ_FRAMES; nFrame++)
+    {
+        /* Denser & sparser frames in turn */
+        const uint32_t knOneIn = 1U + (nFrame % 6U);
+        for (uint8_t y = 0U; y < PANEL_HEIGHT; y++)
+        {
+            for (uint8_t x = 0U; x < PANEL_WIDTH; x++)
+            {
+                if ((esp_random() % knOneIn) == 0U) {
+                    oPanel.drawPixel(x, y, randomColour());
+                }
+            }
+        }
+        encodeChecked();
+    }
+}
+
+void test_round_trip_session()
+{
+    for (uint16_t nFrame = 0U; nFrame < SESSION_FRAMES; nFrame++)
+    {
+        drawRandomFrame(nFrame);
+        const uint16_t knSize = encodeChecked((nFrame % SESSION_KEYFRAMES) == 0U);
+        if (knSize > 0U) {
+            TEST_ASSERT_TRUE_MESSAGE(decodeFrame(anBuffer, knSize), "Malformed frame");
+        }
+        TEST_ASSERT_TRUE_MESSAGE(decodedMatchesPanel(), "Decoded image differs from the panel");
+    }
+    /* Nothing left to send once everything has been */
+    TEST_ASSERT_EQUAL_UINT32(0U, encodeChecked());
+}
+
+void test_carousel_overhead()
+{
+    /* The sketch's own carousel on the virtual clock, a mirror frame encoded each time a carousel frame takes the matrix */
+    const char kacMessage[] = "You are doing great today";
+    hostUseVirtualTime(true);
+    xSemaphoreTake(oLEDMatrixMutex, portMAX_DELAY);
+    matrix.fillScreen(0U);
+    const uint16_t knKeyframe = encodeChecked(true, matrix);
+    xSemaphoreGive(oLEDMatrixMutex);
+    TEST_ASSERT_TRUE(decodeFrame(anBuffer, knKeyframe));
+
+    oMirrorRun = {0U, 0U, 0U, true};
+    hostOnMutexTake(mirrorMatrix);
+    cycleMessage(textView(kacMessage), CAROUSEL_SPEED);
+    hostOnMutexTake(nullptr);
+    /* And the last frame it drew */
+    mirrorMatrix();
+    TEST_ASSERT_TRUE_MESSAGE(oMirrorRun.bWellFormed, "Carousel mirror frame overflowed or didn't decode");
+    TEST_ASSERT_TRUE(decodedMatchesPanel(matrix));
+    /* Every scroll position made its own frame */
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(kaoLayout[REGION_CAROUSEL].nWidth + (sizeof(kacMessage) - 1U) * TEXT_WIDTH, oMirrorRun.nFrames);
+    const uint32_t knAverage = oMirrorRun.nBytes / oMirrorRun.nFrames;
+    const uint32_t knMaxFrame = oMirrorRun.nMaxFrame;
+
+    /* Serial carries about a tenth of its baud rate in bytes */
+    const uint32_t knLinkBytesPerSecond = MIRROR_BAUD / 10U;
+    printf("Mirror overhead, %ux%u carousel: %u B/frame average, %u B max, keyframe %u B, "
+           "%u B/s at %u fps = %u%% of %u baud\n",
+           (unsigned)PANEL_WIDTH, (unsigned)PANEL_HEIGHT, (unsigned)knAverage, (unsigned)knMaxFrame, (unsigned)knKeyframe,
+           (unsigned)(knAverage * CAROUSEL_SPEED), (unsigned)CAROUSEL_SPEED,
+           (unsigned)((knAverage * CAROUSEL_SPEED * 100U) / knLinkBytesPerSecond), (unsigned)MIRROR_BAUD);
+    /* Deltas are the point: a scrolling row band must cost a fraction of the panel */
+    TEST_ASSERT_LESS_THAN_UINT32(knKeyframe / 4U, knAverage);
+    TEST_ASSERT_LESS_THAN_UINT32(knLinkBytesPerSecond / 2U, knAverage * CAROUSEL_SPEED);
+    /* Even the largest carousel frame goes out within its frame time */
+    TEST_ASSERT_LESS_THAN_UINT32(knLinkBytesPerSecond, knMaxFrame * CAROUSEL_SPEED);
+    hostUseVirtualTime(false);
+}
+
+void test_panel_mirror_py_replays_session()
+{
+    /* Only a missing python3 or decoder is a reason to skip, a decoder that fails is a failure */
+    FILE *poScript = fopen(DECODER_SCRIPT, "r");
+    if (poScript == NULL) {
+        TEST_IGNORE_MESSAGE(DECODER_SCRIPT " not found, run from the project directory");
+    }
+    fclose(poScript);
+    if (system("python3 -c '' 2> /dev/null") != 0) {
+        TEST_IGNORE_MESSAGE("python3 not available");
+    }
+
+    FILE *poRecording = fopen(SESSION_RECORDING, "wb");
+    if (poRecording == NULL) {
+        TEST_IGNORE_MESSAGE("No .pio directory to record into");
+    }
+    fwrite("PMREC1\n", 1U, 7U, poRecording);
+    const char kacDebug[] = "Carousel: 12 frames, 0 missed deadlines PM\n";
+    for (uint16_t nFrame = 0U; nFrame < SESSION_FRAMES; nFrame++)
+    {
+        drawRandomFrame(nFrame);
+        const uint16_t knSize = encodeChecked((nFrame % SESSION_KEYFRAMES) == 0U);
+        /* Debug text between frames, and frames split across serial reads, as a live port delivers them */
+        writeRecord(poRecording, nFrame / 30.0, kacDebug, sizeof(kacDebug) - 1U);
+        writeRecord(poRecording, nFrame / 30.0, anBuffer, knSize / 2U);
+        writeRecord(poRecording, nFrame / 30.0, anBuffer + knSize / 2U, knSize - knSize / 2U);
+    }
+    fclose(poRecording);
+
+    remove(SESSION_IMAGE);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, system(DECODER_COMMAND " 2> " SESSION_IMAGE ".log"), DECODER_SCRIPT " failed, see " SESSION_IMAGE ".log");
+    FILE *poImage = fopen(SESSION_IMAGE, "rb");
+    TEST_ASSERT_NOT_NULL(poImage);
+    unsigned nWidth = 0U, nHeight = 0U, nMax = 0U;
+    TEST_ASSERT_EQUAL_INT(3, fscanf(poImage, "P6 %u %u %u", &nWidth, &nHeight, &nMax));
+    fgetc(poImage);
+    TEST_ASSERT_EQUAL_UINT32(PANEL_WIDTH, nWidth);
+    TEST_ASSERT_EQUAL_UINT32(PANEL_HEIGHT, nHeight);
+    bool bMatches = true;
+    for (uint8_t y = 0U; y < PANEL_HEIGHT; y++)
+    {
+        for (uint8_t x = 0U; x < PANEL_WIDTH; x++)
+        {
+            /* The PPM scales 4-bit channels by 17 */
+            const uint16_t kn444 = shown(oPanel, x, y);
+            bMatches &= (fgetc(poImage) == (int)(((kn444 >> 8U) & 0xFU) * 17U));
+            bMatches &= (fgetc(poImage) == (int)(((kn444 >> 4U) & 0xFU) * 17U));
+            bMatches &= (fgetc(poImage) == (int)((kn444 & 0xFU) * 17U));
+        }
+    }
+    fclose(poImage);
+    TEST_ASSERT_TRUE_MESSAGE(bMatches, "panel_mirror.py rebuilt a different image");
+}
+
+void test_redraw_waits_for_the_matrix()
+{
+    /* The whole redraw, blanking included, must queue behind whoever holds the matrix */
+    const local_time koNow = {2022, 10U, 19U, 10U, 15U, 0U, TZ_WEDNESDAY, true};
+    hostUseVirtualTime(false);
+    xSemaphoreTake(oLEDMatrixMutex, portMAX_DELAY);
+    const uint32_t knWritesBefore = matrix.driverWrites();
+    std::thread oRedraw([&koNow]() { blankAndDrawTime(koNow); });
+    delay(HOLD_MILLIS);
+    const uint32_t knWritesWhileHeld = matrix.driverWrites();
+    xSemaphoreGive(oLEDMatrixMutex);
+    oRedraw.join();
+    TEST_ASSERT_EQUAL_UINT32(knWritesBefore, knWritesWhileHeld);
+    TEST_ASSERT_GREATER_THAN_UINT32(knWritesBefore, matrix.driverWrites());
+}
+
+int main()
+{
+    oPanel.begin();
+    oLEDMatrixMutex = xSemaphoreCreateMutex();
+    matrix.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_keyframe_fits);
+    RUN_TEST(test_every_third_column_fits);
+    RUN_TEST(test_pixel_pairs_every_fourth_column_fit);
+    RUN_TEST(test_random_changes_fit);
+    RUN_TEST(test_round_trip_session);
+    RUN_TEST(test_carousel_overhead);
+    RUN_TEST(test_panel_mirror_py_replays_session);
+    RUN_TEST(test_redraw_waits_for_the_matrix);
+    return UNITY_END();
+}
@@ -0,0 +1,90 @@
+//
+// Board pixels onto the tile chain at this env's board size: every pixel gets its own place on the strip, inside the
+// tile it belongs to, and on boards more than one tile high the lower tile rows follow the upper ones along the chain.
+//
+
+#include <Arduino.h>
+#include <unity.h>
+#include "panel_geometry.h"
+#include "shadow_panel.h"
+
+/* Strip the driver sees: every tile side by side */
+#define CHAIN_WIDTH     (PANEL_TILE_WIDTH * PANEL_TILE_COUNT)
+
+static ShadowMatrixPanel oPanel;
+/* Board pixel mapped onto each strip position, +1 (0 while unmapped) */
+static uint16_t anMappedFrom[PANEL_TILE_HEIGHT][CHAIN_WIDTH];
+
+void setUp()
+{
+    oPanel.fillScreen(0U);
+}
+
+void tearDown()
+{
+}
+
+/*=== T E S T S ===*/
+
+void test_every_pixel_has_its_own_chain_position()
+{
+    memset(anMappedFrom, 0, sizeof(anMappedFrom));
+    for (uint8_t y = 0U; y < PANEL_HEIGHT; y++)
+    {
+        for (uint8_t x = 0U; x < PANEL_WIDTH; x++)
+        {
+            const int16_t knChainX = panelChainX(x, y), knChainY = panelChainY(y);
+            TEST_ASSERT_TRUE((knChainX >= 0) && (knChainX < (int16_t)CHAIN_WIDTH));
+            TEST_ASSERT_TRUE((knChainY >= 0) && (knChainY < (int16_t)PANEL_TILE_HEIGHT));
+            TEST_ASSERT_EQUAL_UINT16_MESSAGE(0U, anMappedFrom[knChainY][knChainX], "Two board pixels share a chain position");
+            anMappedFrom[knChainY][knChainX] = (uint16_t)(y * PANEL_WIDTH + x + 1U);
+        }
+    }
+}
+
+void test_pixels_land_on_their_tile()
+{
+    for (uint8_t y = 0U; y < PANEL_HEIGHT; y++)
+    {
+        for (uint8_t x = 0U; x < PANEL_WIDTH; x++)
+        {
+            /* Tiles are chained row by row, left to right */
+            const uint16_t knTile = (y / PANEL_TILE_HEIGHT) * PANEL_CHAIN_COLS + (x / PANEL_TILE_WIDTH);
+            const int16_t knChainX = panelChainX(x, y);
+            TEST_ASSERT_EQUAL_UINT16(knTile, knChainX / PANEL_TILE_WIDTH);
+            TEST_ASSERT_EQUAL_INT16(x % PANEL_TILE_WIDTH, knChainX % PANEL_TILE_WIDTH);
+            TEST_ASSERT_EQUAL_INT16(y % PANEL_TILE_HEIGHT, panelChainY(y));
+        }
+    }
+}
+
+void test_lower_tile_rows_follow_along_the_chain()
+{
+#if PANEL_CHAIN_ROWS > 1U
+    /* First pixel of the second tile row comes straight after the whole first row of tiles */
+    TEST_ASSERT_EQUAL_INT16(PANEL_WIDTH, panelChainX(0, PANEL_TILE_HEIGHT));
+    TEST_ASSERT_EQUAL_INT16(0, panelChainY(PANEL_TILE_HEIGHT));
+    /* Last board pixel is the last on the strip */
+    TEST_ASSERT_EQUAL_INT16(CHAIN_WIDTH - 1U, panelChainX(PANEL_WIDTH - 1U, PANEL_HEIGHT - 1U));
+    TEST_ASSERT_EQUAL_INT16(PANEL_TILE_HEIGHT - 1U, panelChainY(PANEL_HEIGHT - 1U));
+
+    /* And drawing reaches the driver there: a pixel inside the lower left tile, away from its edges */
+    const int16_t x = 3, y = PANEL_TILE_HEIGHT + 8;
+    oPanel.drawPixel(x, y, oPanel.color444(15U, 15U, 15U));
+    TEST_ASSERT_NOT_EQUAL(0U, oPanel.litPixel(PANEL_WIDTH + 3, 8));
+    TEST_ASSERT_EQUAL_UINT16(0U, oPanel.litPixel(3, 8));
+#else
+    TEST_IGNORE_MESSAGE("One tile row, run native_64x64 or native_128x64");
+#endif
+}
+
+int main()
+{
+    oPanel.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_every_pixel_has_its_own_chain_position);
+    RUN_TEST(test_pixels_land_on_their_tile);
+    RUN_TEST(test_lower_tile_rows_follow_along_the_chain);
+    return UNITY_END();
+}
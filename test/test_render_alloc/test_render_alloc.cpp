@@ -0,0 +1,96 @@
+//
+// The render path must never touch the heap: counts allocations while the clock regions & the carousel draw
+// against the stand-in panel, and while the stats lines print.
+//
+
+#include <Arduino.h>
+#include <unity.h>
+#include "host_control.h"
+#include "time_zone_rules.h"
+#include "text_view.h"
+#include "shadow_panel.h"
+
+/* From main.cpp */
+extern SemaphoreHandle_t oLEDMatrixMutex;
+extern ShadowMatrixPanel matrix;
+void setDateAndTime(const local_time &koNow);
+void blankAndDrawTime(const local_time &koNow);
+void cycleMessage(const text_view koMessage, const uint32_t knPixelsPerSecond);
+void printCarouselStats();
+void printMirrorStats();
+
+/* Wednesday 2022-10-19 10:15:00 IST, an ordinary minute with no celebration */
+static const local_time koOrdinaryMinute = {2022, 10U, 19U, 10U, 15U, 0U, TZ_WEDNESDAY, true};
+
+void setUp()
+{
+    hostUseVirtualTime(true);
+    hostSerialClear();
+}
+
+void tearDown()
+{
+    hostCountAllocations(false);
+}
+
+/*=== T E S T S ===*/
+
+void test_counter_sees_allocations()
+{
+    /* The harness itself: a long printf & a heap string must both register */
+    hostCountAllocations(true);
+    Serial.printf("%s\n", "This line is well over the sixty-four characters printf can format on the stack");
+    TEST_ASSERT_EQUAL_UINT32(1U, hostAllocations());
+    String sHeap("held on the heap");
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(2U, hostAllocations());
+    int *pnBlock = new int(1);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(3U, hostAllocations());
+    delete pnBlock;
+}
+
+void test_clock_regions_draw_without_allocating()
+{
+    const uint32_t knWritesBefore = matrix.driverWrites();
+    hostCountAllocations(true);
+    blankAndDrawTime(koOrdinaryMinute);
+    local_time oNextMinute = koOrdinaryMinute;
+    oNextMinute.nMinute++;
+    setDateAndTime(oNextMinute);
+    TEST_ASSERT_EQUAL_UINT32(0U, hostAllocations());
+    TEST_ASSERT_GREATER_THAN_UINT32(knWritesBefore, matrix.driverWrites());
+}
+
+void test_carousel_draws_without_allocating()
+{
+    const uint32_t knWritesBefore = matrix.driverWrites();
+    const uint32_t knStart = millis();
+    hostCountAllocations(true);
+    cycleMessage(textView("You are doing great today"), 66U);
+    TEST_ASSERT_EQUAL_UINT32(0U, hostAllocations());
+    /* The whole message crossed the region */
+    TEST_ASSERT_GREATER_THAN_UINT32(knWritesBefore, matrix.driverWrites());
+    TEST_ASSERT_GREATER_THAN_UINT32(knStart + 3000U, millis());
+}
+
+void test_stats_print_without_allocating()
+{
+    hostCountAllocations(true);
+    printCarouselStats();
+    printMirrorStats();
+    TEST_ASSERT_EQUAL_UINT32(0U, hostAllocations());
+    TEST_ASSERT_NOT_NULL(strstr(hostSerialOutput(), "Carousel jitter:"));
+    TEST_ASSERT_NOT_NULL(strstr(hostSerialOutput(), "Mirror encode:"));
+}
+
+int main()
+{
+    oLEDMatrixMutex = xSemaphoreCreateMutex();
+    matrix.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_counter_sees_allocations);
+    RUN_TEST(test_clock_regions_draw_without_allocating);
+    RUN_TEST(test_carousel_draws_without_allocating);
+    RUN_TEST(test_stats_print_without_allocating);
+    return UNITY_END();
+}
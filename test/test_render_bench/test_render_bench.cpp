@@ -0,0 +1,281 @@
+//
+// BandRenderer at this env's board size: frames come out pixel exact, the window splits evenly between the cores,
+// the flush grows with the pixels that changed rather than the panel, and the rainbow bitmap renders one tile's
+// worth of pixels a frame on any board. Each native env (64x32, 128x32, 64x64, 128x64) checks its own size.
+//
+
+#include <Arduino.h>
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <thread>
+#include "host_control.h"
+#include "panel_geometry.h"
+#include "shadow_panel.h"
+#include "band_renderer.h"
+
+/* From main.cpp */
+extern SemaphoreHandle_t oLEDMatrixMutex;
+extern ShadowMatrixPanel matrix;
+extern BandRenderer oBandRenderer;
+void printRainbowBitmap(const unsigned char bitmap[], const uint16_t nCycles);
+void fillRainbowBand(uint16_t (*panFrame)[PANEL_WIDTH], const panel_rect &koBand, void *pvJob);
+
+/* Frames timed per measurement */
+#define BENCH_FRAMES        100U
+/* Side of the square that moves in the partial-change frames */
+#define SPRITE_SIZE         8U
+/* Rainbow frames drawn per check */
+#define RAINBOW_CYCLES      4U
+/* Frame value no fill writes */
+#define UNFILLED            0xF000U
+
+/* Where a frame is in its animation */
+typedef struct BENCH_JOB {
+    uint16_t    nPhase;     /* Frame number */
+    bool        bSprite;    /* Draw only a square moving over black rather than a full plasma */
+    panel_rect  oTopBand;   /* Last band filled starting at the window's top */
+    panel_rect  oRestBand;  /* Last band filled below it */
+    uint8_t     nWindowTop; /* Top row of the window being rendered */
+} bench_job;
+
+/* As main.cpp's rainbow_job */
+typedef struct RAINBOW_JOB {
+    const unsigned char *kpnBitmap;     /* Bitmap to draw, centred on the board */
+    uint16_t            n444;           /* Colour of the set bits this frame (0x0RGB) */
+} rainbow_job;
+
+static ShadowMatrixPanel oPanel;
+static BandRenderer oRenderer;
+/* Single-core reference frame */
+static uint16_t anReference[PANEL_HEIGHT][PANEL_WIDTH];
+
+/**
+ * Plasma (every pixel changes, with enough maths a pixel to dwarf the hand-off between cores) or a moving square
+ */
+static void fillBenchBand(uint16_t (*panFrame)[PANEL_WIDTH], const panel_rect &koBand, void *pvJob)
+{
+    bench_job *poJob = (bench_job *)pvJob;
+    /* Each core writes only its own slot */
+    ((koBand.nTop == poJob->nWindowTop) ? poJob->oTopBand : poJob->oRestBand) = koBand;
+    const float kfPhase = poJob->nPhase * 0.2f;
+    for (uint8_t y = koBand.nTop; y < (koBand.nTop + koBand.nHeight); y++)
+    {
+        for (uint8_t x = koBand.nLeft; x < (koBand.nLeft + koBand.nWidth); x++)
+        {
+            if (poJob->bSprite) {
+                const uint8_t knLeft = poJob->nPhase % (PANEL_WIDTH - SPRITE_SIZE);
+                const bool kbInside = (x >= knLeft) && (x < (knLeft + SPRITE_SIZE)) && (y < SPRITE_SIZE);
+                panFrame[y][x] = kbInside ? 0x0FFFU : 0U;
+                continue;
+            }
+            const float kfValue = sinf(x * 0.11f + kfPhase) + sinf(y * 0.13f - kfPhase) + sinf((x + y) * 0.07f + kfPhase)
+                                + sinf(sqrtf((float)(x * x + y * y)) * 0.09f);
+            const uint8_t knLevel = (uint8_t)((kfValue + 4.0f) * 1.875f);
+            panFrame[y][x] = (uint16_t)((knLevel << 8U) | ((15U - knLevel) << 4U) | ((knLevel + poJob->nPhase) & 0xFU));
+        }
+    }
+}
+
+/**
+ * What the panel shows at a board position, read back from the driver as 0x0RGB (full brightness)
+ */
+static uint16_t shown(const ShadowMatrixPanel &koPanel, const uint8_t x, const uint8_t y)
+{
+    const uint16_t knDriver = koPanel.litPixel(panelChainX(x, y), panelChainY(y));
+    uint16_t n444 = 0U;
+    for (uint8_t nChannel = 0U; nChannel < 3U; nChannel++)
+    {
+        /* Find each channel through color444() rather than assuming the driver's bit layout */
+        const uint16_t knUnit = koPanel.color444(nChannel == 0U, nChannel == 1U, nChannel == 2U);
+        n444 |= ((knDriver / knUnit) & 0xFU) << (8U - 4U * nChannel);
+    }
+    return n444;
+}
+
+static bool panelMatchesReference()
+{
+    for (uint8_t y = 0U; y < PANEL_HEIGHT; y++)
+    {
+        for (uint8_t x = 0U; x < PANEL_WIDTH; x++)
+        {
+            if (shown(oPanel, x, y) != anReference[y][x]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void setUp()
+{
+    hostUseVirtualTime(false);
+    oPanel.fillScreen(0U);
+}
+
+void tearDown()
+{
+}
+
+/*=== T E S T S ===*/
+
+void test_bands_match_one_core_filling()
+{
+    for (uint16_t nFrame = 0U; nFrame < 8U; nFrame++)
+    {
+        bench_job oJob = {nFrame, (nFrame & 1U) != 0U, {}, {}, 0U};
+        oRenderer.renderFrame(fillBenchBand, &oJob);
+        fillBenchBand(anReference, koPanelRect, &oJob);
+        TEST_ASSERT_TRUE_MESSAGE(panelMatchesReference(), "Band-split frame differs from a single-core fill");
+    }
+}
+
+void test_split_fill_divides_the_window()
+{
+    /* An odd-sized window off the board's corner: the helper takes the top half of its rows, the caller the rest */
+    const panel_rect koWindow = {3U, 1U, PANEL_WIDTH - 5U, PANEL_HEIGHT - 4U};
+    bench_job oJob = {0U, false, {}, {}, koWindow.nTop};
+    oRenderer.renderFrame(fillBenchBand, &oJob, koWindow);
+    TEST_ASSERT_EQUAL_UINT8(koWindow.nTop, oJob.oTopBand.nTop);
+    TEST_ASSERT_EQUAL_UINT8(koWindow.nHeight / 2U, oJob.oTopBand.nHeight);
+    TEST_ASSERT_EQUAL_UINT8(koWindow.nTop + koWindow.nHeight / 2U, oJob.oRestBand.nTop);
+    TEST_ASSERT_EQUAL_UINT8(koWindow.nHeight - koWindow.nHeight / 2U, oJob.oRestBand.nHeight);
+    TEST_ASSERT_TRUE((oJob.oTopBand.nLeft == koWindow.nLeft) && (oJob.oTopBand.nWidth == koWindow.nWidth)
+                     && (oJob.oRestBand.nLeft == koWindow.nLeft) && (oJob.oRestBand.nWidth == koWindow.nWidth));
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)koWindow.nWidth * koWindow.nHeight, oRenderer.oStats.nLastWindowPixels);
+
+    /* The window as one core fills it, the rest of the panel untouched */
+    for (uint8_t y = 0U; y < PANEL_HEIGHT; y++)
+    {
+        for (uint8_t x = 0U; x < PANEL_WIDTH; x++)
+        {
+            anReference[y][x] = 0U;
+        }
+    }
+    fillBenchBand(anReference, koWindow, &oJob);
+    TEST_ASSERT_TRUE_MESSAGE(panelMatchesReference(), "Window drawn differently, or drawing spilled outside it");
+
+    /* Timings are for reading only: the host's scheduler decides how much the split gains */
+    uint32_t nStart = micros();
+    for (uint16_t nFrame = 0U; nFrame < BENCH_FRAMES; nFrame++)
+    {
+        oJob.nPhase = nFrame;
+        fillBenchBand(anReference, koPanelRect, &oJob);
+    }
+    const uint32_t knSingleUs = (micros() - nStart) / BENCH_FRAMES;
+    uint32_t nSplitUs = 0U;
+    oJob.nWindowTop = 0U;
+    for (uint16_t nFrame = 0U; nFrame < BENCH_FRAMES; nFrame++)
+    {
+        oJob.nPhase = nFrame;
+        nStart = micros();
+        oRenderer.renderFrame(fillBenchBand, &oJob);
+        nSplitUs += (micros() - nStart) - oRenderer.oStats.nLastFlushUs;
+    }
+    printf("Render bench %ux%u: fill %u us/frame on one core, %u us split across two, %u host cores\n",
+           (unsigned)PANEL_WIDTH, (unsigned)PANEL_HEIGHT, (unsigned)knSingleUs, (unsigned)(nSplitUs / BENCH_FRAMES),
+           std::thread::hardware_concurrency());
+}
+
+void test_flush_follows_changed_pixels()
+{
+    /* A full plasma frame first, then a square moving over black: only the square's old & new edges get drawn */
+    bench_job oJob = {0U, false, {}, {}, 0U};
+    oRenderer.renderFrame(fillBenchBand, &oJob);
+    TEST_ASSERT_GREATER_THAN_UINT32(PANEL_WIDTH * PANEL_HEIGHT * 3U / 4U, oRenderer.oStats.nLastFlushPixels);
+    const uint32_t knFullFlushUs = oRenderer.oStats.nLastFlushUs;
+
+    oJob.bSprite = true;
+    oRenderer.renderFrame(fillBenchBand, &oJob);
+    uint32_t nFlushUs = 0U;
+    for (uint16_t nFrame = 1U; nFrame <= BENCH_FRAMES; nFrame++)
+    {
+        oJob.nPhase = nFrame;
+        oRenderer.renderFrame(fillBenchBand, &oJob);
+        /* One column leaves, one arrives (or the square jumps back to the left edge) */
+        const uint32_t knExpected = ((nFrame % (PANEL_WIDTH - SPRITE_SIZE)) == 0U) ? (2U * SPRITE_SIZE * SPRITE_SIZE) : (2U * SPRITE_SIZE);
+        TEST_ASSERT_EQUAL_UINT32(knExpected, oRenderer.oStats.nLastFlushPixels);
+        nFlushUs += oRenderer.oStats.nLastFlushUs;
+    }
+    printf("Render bench %ux%u: flush %u us for the whole panel, %u us for a moving %ux%u square\n",
+           (unsigned)PANEL_WIDTH, (unsigned)PANEL_HEIGHT, (unsigned)knFullFlushUs, (unsigned)(nFlushUs / BENCH_FRAMES),
+           (unsigned)SPRITE_SIZE, (unsigned)SPRITE_SIZE);
+
+    /* An unchanged frame draws nothing */
+    oRenderer.renderFrame(fillBenchBand, &oJob);
+    TEST_ASSERT_EQUAL_UINT32(0U, oRenderer.oStats.nLastFlushPixels);
+}
+
+void test_rainbow_costs_one_tile_on_any_board()
+{
+    /* Alternate columns of 4 set & 4 clear bits, so the colour's position shows */
+    static unsigned char anBitmap[PANEL_TILE_WIDTH * PANEL_TILE_HEIGHT / 8U];
+    memset(anBitmap, 0xF0, sizeof(anBitmap));
+    hostUseVirtualTime(true);
+    xSemaphoreTake(oLEDMatrixMutex, portMAX_DELAY);
+    matrix.fillScreen(0U);
+    xSemaphoreGive(oLEDMatrixMutex);
+    printRainbowBitmap(anBitmap, RAINBOW_CYCLES);
+
+    /* Pixels filled & compared a frame stay at one tile's while the board grows PANEL_TILE_COUNT times */
+    const uint32_t knTilePixels = PANEL_TILE_WIDTH * PANEL_TILE_HEIGHT;
+    printf("Rainbow %ux%u: %u px a frame, 1/%u of the board\n", (unsigned)PANEL_WIDTH, (unsigned)PANEL_HEIGHT,
+           (unsigned)oBandRenderer.oStats.nLastWindowPixels, (unsigned)PANEL_TILE_COUNT);
+    TEST_ASSERT_EQUAL_UINT32(RAINBOW_CYCLES, oBandRenderer.oStats.nFrames);
+    TEST_ASSERT_EQUAL_UINT32(knTilePixels, oBandRenderer.oStats.nLastWindowPixels);
+    TEST_ASSERT_EQUAL_UINT32(PANEL_WIDTH * PANEL_HEIGHT, oBandRenderer.oStats.nLastWindowPixels * PANEL_TILE_COUNT);
+
+    /* Centred, with the rest of the board left blank */
+    const uint8_t knLeft = (PANEL_WIDTH - PANEL_TILE_WIDTH) / 2U, knTop = (PANEL_HEIGHT - PANEL_TILE_HEIGHT) / 2U;
+    bool bPlaced = true;
+    for (uint8_t y = 0U; y < PANEL_HEIGHT; y++)
+    {
+        for (uint8_t x = 0U; x < PANEL_WIDTH; x++)
+        {
+            const bool kbInside = (x >= knLeft) && (x < (knLeft + PANEL_TILE_WIDTH)) && (y >= knTop) && (y < (knTop + PANEL_TILE_HEIGHT));
+            bPlaced &= ((shown(matrix, x, y) != 0U) == (kbInside && (((x - knLeft) & 4U) == 0U)));
+        }
+    }
+    TEST_ASSERT_TRUE_MESSAGE(bPlaced, "Rainbow bitmap misplaced, or drawn outside its window");
+
+    /* A band fill writes its band & nothing else */
+    static uint16_t anFrame[PANEL_HEIGHT][PANEL_WIDTH];
+    for (uint8_t y = 0U; y < PANEL_HEIGHT; y++)
+    {
+        for (uint8_t x = 0U; x < PANEL_WIDTH; x++)
+        {
+            anFrame[y][x] = UNFILLED;
+        }
+    }
+    rainbow_job oJob = {anBitmap, 0x0F00U};
+    const panel_rect koBand = {knLeft, (uint8_t)(knTop + PANEL_TILE_HEIGHT / 2U), PANEL_TILE_WIDTH, PANEL_TILE_HEIGHT / 2U};
+    fillRainbowBand(anFrame, koBand, &oJob);
+    uint32_t nWritten = 0U;
+    for (uint8_t y = 0U; y < PANEL_HEIGHT; y++)
+    {
+        for (uint8_t x = 0U; x < PANEL_WIDTH; x++)
+        {
+            nWritten += (anFrame[y][x] != UNFILLED) ? 1U : 0U;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(knTilePixels / 2U, nWritten);
+    TEST_ASSERT_EQUAL_HEX16(0x0F00U, anFrame[koBand.nTop][koBand.nLeft]);
+    TEST_ASSERT_EQUAL_HEX16(0U, anFrame[koBand.nTop][koBand.nLeft + 4U]);
+    hostUseVirtualTime(false);
+}
+
+int main()
+{
+    oPanel.begin();
+    oRenderer.begin(&oPanel, 1);
+    oLEDMatrixMutex = xSemaphoreCreateMutex();
+    matrix.begin();
+    oBandRenderer.begin(&matrix, 1);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_bands_match_one_core_filling);
+    RUN_TEST(test_split_fill_divides_the_window);
+    RUN_TEST(test_flush_follows_changed_pixels);
+    RUN_TEST(test_rainbow_costs_one_tile_on_any_board);
+    return UNITY_END();
+}
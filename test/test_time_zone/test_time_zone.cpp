@@ -0,0 +1,226 @@
+//
+// time_zone_rules.h against the IANA tz database: Dublin & Berlin through 2020-2031,
+// and the 07:00 wake / 23:00 sleep scheduling across 2022's DST changes.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <unity.h>
+#include "time_zone_rules.h"
+
+/* Years the reference table covers */
+#define TZDATA_FIRST_YEAR   2020
+#define TZDATA_LAST_YEAR    2031
+#define TZDATA_YEARS        (TZDATA_LAST_YEAR - TZDATA_FIRST_YEAR + 1)
+/* Sweep step, fine enough to land on every transition (all at :00 UTC) */
+#define SWEEP_STEP          (15 * 60)
+/* Scheduling probe step, co-prime with hours so it visits every minute of the day over the year */
+#define SCHEDULE_STEP       (17 * 60 + 13)
+#define WAKE_SECOND_OF_DAY  (7 * 3600)
+#define SLEEP_SECOND_OF_DAY (23 * 3600)
+
+/*
+ * UTC instants Europe/Dublin & Europe/Berlin enter & leave summer time, from tzdata (zoneinfo).
+ * Both zones follow the EU rule, so they change at the same instant.
+ */
+static const int64_t kanTzdataTransitions[TZDATA_YEARS][2] = {
+    {1585443600, 1603587600},   /* 2020-03-29, 2020-10-25 */
+    {1616893200, 1635642000},   /* 2021-03-28, 2021-10-31 */
+    {1648342800, 1667091600},   /* 2022-03-27, 2022-10-30 */
+    {1679792400, 1698541200},   /* 2023-03-26, 2023-10-29 */
+    {1711846800, 1729990800},   /* 2024-03-31, 2024-10-27 */
+    {1743296400, 1761440400},   /* 2025-03-30, 2025-10-26 */
+    {1774746000, 1792890000},   /* 2026-03-29, 2026-10-25 */
+    {1806195600, 1824944400},   /* 2027-03-28, 2027-10-31 */
+    {1837645200, 1856394000},   /* 2028-03-26, 2028-10-29 */
+    {1869094800, 1887843600},   /* 2029-03-25, 2029-10-28 */
+    {1901149200, 1919293200},   /* 2030-03-31, 2030-10-27 */
+    {1932598800, 1950742800},   /* 2031-03-30, 2031-10-26 */
+};
+
+/* A zone as tzdata has it, next to the rule under test */
+typedef struct REFERENCE_ZONE {
+    const char     *kpcName;
+    const tz_rule  *kpoRule;
+    int32_t         nWinterOffset;  /* UTC offset outside summer time */
+    int32_t         nSummerOffset;  /* UTC offset in summer time */
+} reference_zone;
+
+static const reference_zone kaoZones[] = {
+    {"Europe/Dublin", &koTzEuropeDublin, 0,    3600},
+    {"Europe/Berlin", &koTzEuropeBerlin, 3600, 7200},
+};
+
+static int64_t epochOf(const int nYear, const int nMonth, const int nDay)
+{
+    return (int64_t)tzDaysFromCivil(nYear, nMonth, nDay) * TZ_SECONDS_PER_DAY;
+}
+
+static bool referenceSummer(const int64_t knUTC)
+{
+    for (uint8_t nYear = 0U; nYear < TZDATA_YEARS; nYear++)
+    {
+        if ((knUTC >= kanTzdataTransitions[nYear][0]) && (knUTC < kanTzdataTransitions[nYear][1])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int32_t referenceOffset(const int64_t knUTC, const reference_zone &koZone)
+{
+    return referenceSummer(knUTC) ? koZone.nSummerOffset : koZone.nWinterOffset;
+}
+
+/**
+ * Next instant after knUTC the zone's clock reads nSecondOfDay, by trying both offsets on the days around it
+ */
+static int64_t referenceNext(const int64_t knUTC, const reference_zone &koZone, const int32_t knSecondOfDay)
+{
+    const int64_t knLocalDay = (knUTC + referenceOffset(knUTC, koZone)) / TZ_SECONDS_PER_DAY;
+    int64_t nBest = INT64_MAX;
+    for (int64_t nDay = knLocalDay - 1; nDay <= knLocalDay + 2; nDay++)
+    {
+        const int64_t knLocal = nDay * TZ_SECONDS_PER_DAY + knSecondOfDay;
+        const int32_t kanOffsets[2] = {koZone.nWinterOffset, koZone.nSummerOffset};
+        for (uint8_t n = 0U; n < 2U; n++)
+        {
+            const int64_t knCandidate = knLocal - kanOffsets[n];
+            if ((knCandidate > knUTC) && (referenceOffset(knCandidate, koZone) == kanOffsets[n]) && (knCandidate < nBest)) {
+                nBest = knCandidate;
+            }
+        }
+    }
+    return nBest;
+}
+
+static void checkLocalTime(const int64_t knUTC, const reference_zone &koZone)
+{
+    const bool kbSummer = referenceSummer(knUTC);
+    const time_t knLocal = (time_t)(knUTC + (kbSummer ? koZone.nSummerOffset : koZone.nWinterOffset));
+    struct tm oExpected;
+    gmtime_r(&knLocal, &oExpected);
+    const local_time koGot = tzToLocalTime(knUTC, *koZone.kpoRule);
+
+    if ((koGot.nYear != oExpected.tm_year + 1900) || (koGot.nMonth != oExpected.tm_mon + 1) || (koGot.nDay != oExpected.tm_mday)
+        || (koGot.nHour != oExpected.tm_hour) || (koGot.nMinute != oExpected.tm_min) || (koGot.nSecond != oExpected.tm_sec)
+        || (koGot.nDayOfWeek != oExpected.tm_wday) || (koGot.bDst != kbSummer)) {
+        char acMessage[160];
+        snprintf(acMessage, sizeof(acMessage), "%s at %lld: expected %04d-%02d-%02d %02d:%02d dow %d dst %d, got %04d-%02d-%02d %02d:%02d dow %u dst %d",
+                 koZone.kpcName, (long long)knUTC,
+                 oExpected.tm_year + 1900, oExpected.tm_mon + 1, oExpected.tm_mday, oExpected.tm_hour, oExpected.tm_min, oExpected.tm_wday, kbSummer,
+                 koGot.nYear, koGot.nMonth, koGot.nDay, koGot.nHour, koGot.nMinute, koGot.nDayOfWeek, koGot.bDst);
+        TEST_FAIL_MESSAGE(acMessage);
+    }
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+/*=== T E S T S ===*/
+
+void test_transitions_match_tzdata()
+{
+    for (int32_t nYear = TZDATA_FIRST_YEAR; nYear <= TZDATA_LAST_YEAR; nYear++)
+    {
+        const int64_t *kpnExpected = kanTzdataTransitions[nYear - TZDATA_FIRST_YEAR];
+        TEST_ASSERT_EQUAL_INT64(kpnExpected[0], tzTransitionEpoch(nYear, koTzEuropeDublin.oDstStart));
+        TEST_ASSERT_EQUAL_INT64(kpnExpected[1], tzTransitionEpoch(nYear, koTzEuropeDublin.oDstEnd));
+        TEST_ASSERT_EQUAL_INT64(kpnExpected[0], tzTransitionEpoch(nYear, koTzEuropeBerlin.oDstStart));
+        TEST_ASSERT_EQUAL_INT64(kpnExpected[1], tzTransitionEpoch(nYear, koTzEuropeBerlin.oDstEnd));
+    }
+}
+
+void test_local_time_sweep_2020_to_2031()
+{
+    const int64_t knStart = epochOf(TZDATA_FIRST_YEAR, 1, 1);
+    const int64_t knEnd = epochOf(TZDATA_LAST_YEAR + 1, 1, 1);
+    for (const reference_zone &koZone : kaoZones)
+    {
+        for (int64_t t = knStart; t < knEnd; t += SWEEP_STEP)
+        {
+            checkLocalTime(t, koZone);
+        }
+    }
+}
+
+void test_local_time_either_side_of_transitions()
+{
+    for (const reference_zone &koZone : kaoZones)
+    {
+        for (uint8_t nYear = 0U; nYear < TZDATA_YEARS; nYear++)
+        {
+            for (uint8_t nEdge = 0U; nEdge < 2U; nEdge++)
+            {
+                const int64_t knAt = kanTzdataTransitions[nYear][nEdge];
+                checkLocalTime(knAt - 1, koZone);
+                checkLocalTime(knAt, koZone);
+                checkLocalTime(knAt + 1, koZone);
+            }
+        }
+    }
+}
+
+void test_wake_and_sleep_scheduling_across_2022()
+{
+    /* From New Year's Eve so the first probes schedule into 2022 */
+    const int64_t knStart = epochOf(2021, 12, 31);
+    const int64_t knEnd = epochOf(2023, 1, 1);
+    const int32_t kanSecondsOfDay[2] = {WAKE_SECOND_OF_DAY, SLEEP_SECOND_OF_DAY};
+    for (const reference_zone &koZone : kaoZones)
+    {
+        for (uint8_t n = 0U; n < 2U; n++)
+        {
+            const int32_t knSecondOfDay = kanSecondsOfDay[n];
+            for (int64_t t = knStart; t < knEnd; t += SCHEDULE_STEP)
+            {
+                const int64_t knNext = tzNextLocalTime(t, *koZone.kpoRule, knSecondOfDay);
+                TEST_ASSERT_EQUAL_INT64_MESSAGE(referenceNext(t, koZone, knSecondOfDay), knNext, koZone.kpcName);
+                /* Never more than a day away, even across a change */
+                TEST_ASSERT_TRUE((knNext - t) <= (TZ_SECONDS_PER_DAY + 3600));
+            }
+        }
+    }
+}
+
+void test_scheduling_on_2022_change_days()
+{
+    /* Exactly at, just before & just after each scheduled time on the days either side of a change */
+    const int64_t kanDays[4] = {epochOf(2022, 3, 26), epochOf(2022, 3, 27), epochOf(2022, 10, 29), epochOf(2022, 10, 30)};
+    const int32_t kanSecondsOfDay[2] = {WAKE_SECOND_OF_DAY, SLEEP_SECOND_OF_DAY};
+    for (const reference_zone &koZone : kaoZones)
+    {
+        for (uint8_t nDay = 0U; nDay < 4U; nDay++)
+        {
+            for (uint8_t n = 0U; n < 2U; n++)
+            {
+                const int64_t knScheduled = tzUTCFromLocal(kanDays[nDay] + kanSecondsOfDay[n], *koZone.kpoRule);
+                for (int64_t t = knScheduled - 1; t <= knScheduled + 1; t++)
+                {
+                    const int64_t knNext = tzNextLocalTime(t, *koZone.kpoRule, kanSecondsOfDay[n]);
+                    TEST_ASSERT_EQUAL_INT64_MESSAGE(referenceNext(t, koZone, kanSecondsOfDay[n]), knNext, koZone.kpcName);
+                    const local_time koAt = tzToLocalTime(knNext, *koZone.kpoRule);
+                    TEST_ASSERT_EQUAL_UINT8(kanSecondsOfDay[n] / 3600, koAt.nHour);
+                    TEST_ASSERT_EQUAL_UINT8(0U, koAt.nMinute);
+                }
+            }
+        }
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_transitions_match_tzdata);
+    RUN_TEST(test_local_time_sweep_2020_to_2031);
+    RUN_TEST(test_local_time_either_side_of_transitions);
+    RUN_TEST(test_wake_and_sleep_scheduling_across_2022);
+    RUN_TEST(test_scheduling_on_2022_change_days);
+    return UNITY_END();
+}
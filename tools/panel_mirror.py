@@ -0,0 +1,239 @@
+#!/usr/bin/env python3
+"""
+Host-side decoder for the panel's serial mirror (MIRROR_ENABLED in src/main.cpp).
+
+Rebuilds the panel image from the delta-encoded frames sent by ShadowMatrixPanel::encodeMirrorFrame(),
+shows it in the terminal, and can record a session to replay later. Any other serial output (debug prints)
+is passed through to stderr.
+
+    panel_mirror.py live /dev/ttyUSB0 [--baud 921600] [--record session.pmr]
+    panel_mirror.py replay session.pmr [--speed 2.0]
+    panel_mirror.py live /dev/ttyUSB0 --ppm last_frame.ppm
+
+Live mode needs pyserial.
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+MAGIC = b"PM"
+HEADER_SIZE = 8
+SPAN_HEADER_SIZE = 3
+FLAG_KEYFRAME = 0x01
+RECORDING_MAGIC = b"PMREC1\n"
+
+
+def packed_size(length):
+    """Bytes taken by `length` 12-bit pixels packed two per three bytes."""
+    return (length * 3 + 1) // 2
+
+
+class MirrorDecoder:
+    """Incremental decoder, feed it serial bytes in any chunking."""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.width = 0
+        self.height = 0
+        self.pixels = []
+        self.synced = False
+        self.frames = 0
+        self.dropped = 0
+        self.bad = 0
+        self.sequence = None
+
+    def feed(self, data):
+        """Consumes bytes, returns (frames decoded, passthrough text)."""
+        self.buffer += data
+        decoded = 0
+        text = bytearray()
+        while True:
+            start = self.buffer.find(MAGIC)
+            if start < 0:
+                # Keep a trailing 'P' in case it's the start of the next magic
+                keep = 1 if self.buffer.endswith(MAGIC[:1]) else 0
+                text += self.buffer[:len(self.buffer) - keep]
+                del self.buffer[:len(self.buffer) - keep]
+                break
+            text += self.buffer[:start]
+            del self.buffer[:start]
+            size = self._frame_size()
+            if size is None:
+                break
+            if size < 0 or not self._apply(self.buffer[:size]):
+                # Not a frame after all, treat the 'P' as text and resync
+                self.bad += 1
+                text += self.buffer[:1]
+                del self.buffer[:1]
+                continue
+            del self.buffer[:size]
+            decoded += 1
+        return decoded, bytes(text)
+
+    def _frame_size(self):
+        """Size of the frame at the start of the buffer, None if incomplete, -1 if malformed."""
+        if len(self.buffer) < HEADER_SIZE:
+            return None
+        width, height = self.buffer[4], self.buffer[5]
+        spans = self.buffer[6] | (self.buffer[7] << 8)
+        if width == 0 or height == 0 or spans > height * width:
+            return -1
+        pos = HEADER_SIZE
+        for _ in range(spans):
+            if len(self.buffer) < pos + SPAN_HEADER_SIZE:
+                return None
+            row, col, length = self.buffer[pos:pos + SPAN_HEADER_SIZE]
+            if row >= height or length == 0 or col + length > width:
+                return -1
+            pos += SPAN_HEADER_SIZE + packed_size(length)
+        if len(self.buffer) < pos + 1:
+            return None
+        return pos + 1
+
+    def _apply(self, frame):
+        if (sum(frame[2:-1]) & 0xFF) != frame[-1]:
+            return False
+        flags, sequence, width, height = frame[2:6]
+        keyframe = bool(flags & FLAG_KEYFRAME)
+        if (width, height) != (self.width, self.height):
+            self.width, self.height = width, height
+            self.pixels = [[0] * width for _ in range(height)]
+            self.synced = False
+        if keyframe:
+            self.synced = True
+        if self.sequence is not None and sequence != (self.sequence + 1) & 0xFF:
+            self.dropped += (sequence - self.sequence - 1) & 0xFF
+        self.sequence = sequence
+
+        spans = frame[6] | (frame[7] << 8)
+        pos = HEADER_SIZE
+        for _ in range(spans):
+            row, col, length = frame[pos:pos + SPAN_HEADER_SIZE]
+            pos += SPAN_HEADER_SIZE
+            packed = frame[pos:pos + packed_size(length)]
+            pos += packed_size(length)
+            for i in range(0, length, 2):
+                b = packed[(i // 2) * 3:(i // 2) * 3 + 3]
+                self.pixels[row][col + i] = (b[0] << 4) | (b[1] >> 4)
+                if i + 1 < length:
+                    self.pixels[row][col + i + 1] = ((b[1] & 0xF) << 8) | b[2]
+        self.frames += 1
+        return True
+
+    def rgb(self, row, col):
+        """8-bit RGB of a pixel."""
+        p = self.pixels[row][col]
+        return ((p >> 8) & 0xF) * 17, ((p >> 4) & 0xF) * 17, (p & 0xF) * 17
+
+
+def render_ansi(decoder):
+    """Two panel rows per terminal line using half blocks."""
+    lines = ["\x1b[H"]
+    for row in range(0, decoder.height, 2):
+        cells = []
+        for col in range(decoder.width):
+            top = decoder.rgb(row, col)
+            bottom = decoder.rgb(row + 1, col) if row + 1 < decoder.height else (0, 0, 0)
+            cells.append("\x1b[38;2;%d;%d;%dm\x1b[48;2;%d;%d;%dm▀" % (top + bottom))
+        lines.append("".join(cells) + "\x1b[0m")
+    state = "" if decoder.synced else "  (waiting for keyframe)"
+    lines.append("frames %d  dropped %d  bad %d%s\x1b[K" % (decoder.frames, decoder.dropped, decoder.bad, state))
+    return "\n".join(lines) + "\n"
+
+
+def write_ppm(decoder, path):
+    with open(path, "wb") as out:
+        out.write(b"P6 %d %d 255\n" % (decoder.width, decoder.height))
+        for row in range(decoder.height):
+            for col in range(decoder.width):
+                out.write(bytes(decoder.rgb(row, col)))
+
+
+def show(decoder, data, args):
+    frames, text = decoder.feed(data)
+    if text:
+        sys.stderr.write(text.decode("ascii", "replace"))
+    if frames and decoder.width and not args.quiet:
+        sys.stdout.write(render_ansi(decoder))
+        sys.stdout.flush()
+
+
+def live(args):
+    import serial
+
+    decoder = MirrorDecoder()
+    recording = open(args.record, "wb") if args.record else None
+    if recording:
+        recording.write(RECORDING_MAGIC)
+    if not args.quiet:
+        sys.stdout.write("\x1b[2J")
+    try:
+        with serial.Serial(args.port, args.baud, timeout=0.05) as port:
+            while True:
+                data = port.read(4096)
+                if not data:
+                    continue
+                if recording:
+                    recording.write(struct.pack("<dI", time.time(), len(data)) + data)
+                show(decoder, data, args)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if recording:
+            recording.close()
+        if args.ppm and decoder.width:
+            write_ppm(decoder, args.ppm)
+
+
+def replay(args):
+    decoder = MirrorDecoder()
+    if not args.quiet:
+        sys.stdout.write("\x1b[2J")
+    with open(args.recording, "rb") as recording:
+        if recording.read(len(RECORDING_MAGIC)) != RECORDING_MAGIC:
+            sys.exit("%s is not a mirror recording" % args.recording)
+        first_stamp = None
+        started = time.time()
+        while True:
+            header = recording.read(12)
+            if len(header) < 12:
+                break
+            stamp, length = struct.unpack("<dI", header)
+            data = recording.read(length)
+            if first_stamp is None:
+                first_stamp = stamp
+            if args.speed > 0:
+                delay = (stamp - first_stamp) / args.speed - (time.time() - started)
+                if delay > 0:
+                    time.sleep(delay)
+            show(decoder, data, args)
+    if args.ppm and decoder.width:
+        write_ppm(decoder, args.ppm)
+    sys.stderr.write("%d frames, %d dropped, %d bad\n" % (decoder.frames, decoder.dropped, decoder.bad))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--ppm", help="write the final panel image to this PPM file")
+    parser.add_argument("--quiet", action="store_true", help="don't draw the panel in the terminal")
+    modes = parser.add_subparsers(dest="mode", required=True)
+
+    live_parser = modes.add_parser("live", help="decode a serial port")
+    live_parser.add_argument("port")
+    live_parser.add_argument("--baud", type=int, default=921600)
+    live_parser.add_argument("--record", help="save the session to this file")
+    live_parser.set_defaults(run=live)
+
+    replay_parser = modes.add_parser("replay", help="play back a recorded session")
+    replay_parser.add_argument("recording")
+    replay_parser.add_argument("--speed", type=float, default=1.0, help="playback speed, 0 for as fast as possible")
+    replay_parser.set_defaults(run=replay)
+
+    args = parser.parse_args()
+    args.run(args)
+
+
+if __name__ == "__main__":
+    main()